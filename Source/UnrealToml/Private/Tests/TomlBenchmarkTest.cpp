@@ -0,0 +1,191 @@
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "UnrealToml.h"
+
+#if WITH_EDITOR
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeExit.h"
+#include "TomlPrivate.h"
+#endif
+
+// Lookup microbenchmarks, run with the Perf filter. Timings are reported as test info, there are no thresholds.
+namespace TomlBenchmark
+{
+    static constexpr int32 NumIterations = 1000000;
+    // Every measured function returns 42
+    static constexpr int64 ExpectedSum = static_cast<int64>(NumIterations) * 42;
+
+    struct FResult
+    {
+        double Seconds;
+        // Checked by the test, which keeps the loop from being optimized away
+        int64 Sum;
+    };
+
+    template<typename FunctionType>
+    FResult Measure(FunctionType&& Function, int32 Iterations = NumIterations)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        int64 Sum = 0;
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            Sum += Function();
+        }
+        return FResult{ FPlatformTime::Seconds() - StartTime, Sum };
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlBenchmarkGetTest, "UnrealToml.Benchmark.Get", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTomlBenchmarkGetTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT("first = 1\nvalue = 42\nlast = 3\n[nested]\nvalue = 42"));
+    UTEST_VALID_EXPR(Toml);
+
+    const FString StringKey = TEXT("value");
+    const TomlBenchmark::FResult StringKeyResult = TomlBenchmark::Measure([&Toml, &StringKey]() { return Toml.Get<int32>(StringKey); });
+    const TomlBenchmark::FResult LiteralKeyResult = TomlBenchmark::Measure([&Toml]() { return Toml.Get<int32>("value"); });
+    const TomlBenchmark::FResult Utf8KeyResult = TomlBenchmark::Measure([&Toml]() { return Toml.Get<int32>(UTF8TEXT("value")); });
+
+    const FString StringPath = TEXT("nested.value");
+    const TomlBenchmark::FResult StringPathResult = TomlBenchmark::Measure([&Toml, &StringPath]() { return Toml.AtPath<int32>(StringPath); });
+    const TomlBenchmark::FResult LiteralPathResult = TomlBenchmark::Measure([&Toml]() { return Toml.AtPath<int32>("nested.value"); });
+    const FTomlPath CompiledPath(StringPath);
+    const TomlBenchmark::FResult CompiledPathResult = TomlBenchmark::Measure([&Toml, &CompiledPath]() { return Toml.AtPath<int32>(CompiledPath); });
+    const FTomlValueHandle Handle = Toml.GetHandleAtPath(StringPath);
+    const TomlBenchmark::FResult HandleResult = TomlBenchmark::Measure([&Handle]() { return Handle.Get<int32>(); });
+
+    UTEST_EQUAL(TEXT("Get<int32> with FString"), StringKeyResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("Get<int32> with literal"), LiteralKeyResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("Get<int32> with UTF8TEXT"), Utf8KeyResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("AtPath<int32> with FString"), StringPathResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("AtPath<int32> with literal"), LiteralPathResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("AtPath<int32> with FTomlPath"), CompiledPathResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("Value handle Get<int32>"), HandleResult.Sum, TomlBenchmark::ExpectedSum);
+
+    AddInfo(FString::Printf(TEXT("%d x Get<int32>: FString %.1f ms, literal %.1f ms, UTF8TEXT %.1f ms"),
+        TomlBenchmark::NumIterations, StringKeyResult.Seconds * 1000.0, LiteralKeyResult.Seconds * 1000.0, Utf8KeyResult.Seconds * 1000.0));
+    AddInfo(FString::Printf(TEXT("%d x AtPath<int32>: FString %.1f ms, literal %.1f ms, FTomlPath %.1f ms, value handle %.1f ms"),
+        TomlBenchmark::NumIterations, StringPathResult.Seconds * 1000.0, LiteralPathResult.Seconds * 1000.0, CompiledPathResult.Seconds * 1000.0, HandleResult.Seconds * 1000.0));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlBenchmarkCheckedGettersTest, "UnrealToml.Benchmark.CheckedGetters", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTomlBenchmarkCheckedGettersTest::RunTest(const FString& Parameters)
+{
+    FString Content;
+    for (int32 KeyIndex = 0; KeyIndex < 64; ++KeyIndex)
+    {
+        Content += FString::Printf(TEXT("key%d = %d\n"), KeyIndex, KeyIndex);
+    }
+    Content += TEXT("value = 42\narray = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42]\n[table]\nvalue = 42");
+    FTomlTable Toml = FTomlTable::LoadString(Content);
+    UTEST_VALID_EXPR(Toml);
+
+    // A checked getter costs one key conversion and one probe, so it should stay close to HasKey alone
+    const FString ValueKey = TEXT("value");
+    const FString ArrayKey = TEXT("array");
+    const FString TableKey = TEXT("table");
+    const TomlBenchmark::FResult HasKeyResult = TomlBenchmark::Measure([&Toml, &ValueKey]() { return Toml.HasKey(ValueKey) ? 42 : 0; });
+    const TomlBenchmark::FResult GetResult = TomlBenchmark::Measure([&Toml, &ValueKey]() { return Toml.Get<int32>(ValueKey); });
+    const TomlBenchmark::FResult GetDefaultResult = TomlBenchmark::Measure([&Toml, &ValueKey]() { return Toml.Get<int32>(ValueKey, 0); });
+    const TomlBenchmark::FResult ArrayViewResult = TomlBenchmark::Measure([&Toml, &ArrayKey]() { return Toml.GetHomoArrayView<int64>(ArrayKey).Num(); });
+    const TomlBenchmark::FResult TableResult = TomlBenchmark::Measure([&Toml, &TableKey]() { return Toml.GetTable(TableKey).IsValid() ? 42 : 0; });
+
+    UTEST_EQUAL(TEXT("HasKey"), HasKeyResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("Get<int32>"), GetResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("Get<int32> with default"), GetDefaultResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("GetHomoArrayView<int64>"), ArrayViewResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("GetTable"), TableResult.Sum, TomlBenchmark::ExpectedSum);
+
+    AddInfo(FString::Printf(TEXT("%d x HasKey %.1f ms, Get<int32> %.1f ms, Get<int32> with default %.1f ms"),
+        TomlBenchmark::NumIterations, HasKeyResult.Seconds * 1000.0, GetResult.Seconds * 1000.0, GetDefaultResult.Seconds * 1000.0));
+    AddInfo(FString::Printf(TEXT("%d x GetHomoArrayView<int64> %.1f ms, GetTable %.1f ms"),
+        TomlBenchmark::NumIterations, ArrayViewResult.Seconds * 1000.0, TableResult.Seconds * 1000.0));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlBenchmarkValueHandleTest, "UnrealToml.Benchmark.ValueHandle", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTomlBenchmarkValueHandleTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT("[ai.tuning]\nspeed = 42"));
+    UTEST_VALID_EXPR(Toml);
+
+    // A handle read pins the document, which costs two atomic reference count updates on top of the read itself
+    const FTomlPath Path(TEXT("ai.tuning.speed"));
+    const FTomlValueHandle Handle = Toml.GetHandleAtPath(Path);
+    TSharedPtr<int32, ESPMode::ThreadSafe> Shared = MakeShared<int32, ESPMode::ThreadSafe>(42);
+    const TWeakPtr<int32, ESPMode::ThreadSafe> Weak = Shared;
+    const TomlBenchmark::FResult HandleResult = TomlBenchmark::Measure([&Handle]() { return Handle.Get<int32>(); });
+    const TomlBenchmark::FResult PinResult = TomlBenchmark::Measure([&Weak]() { return *Weak.Pin(); });
+    const TomlBenchmark::FResult PathResult = TomlBenchmark::Measure([&Toml, &Path]() { return Toml.AtPath<int32>(Path); });
+
+    UTEST_EQUAL(TEXT("Value handle Get<int32>"), HandleResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("TWeakPtr::Pin"), PinResult.Sum, TomlBenchmark::ExpectedSum);
+    UTEST_EQUAL(TEXT("AtPath<int32> with FTomlPath"), PathResult.Sum, TomlBenchmark::ExpectedSum);
+
+    AddInfo(FString::Printf(TEXT("%d x value handle Get<int32> %.1f ms, TWeakPtr::Pin alone %.1f ms, AtPath<int32> with FTomlPath %.1f ms"),
+        TomlBenchmark::NumIterations, HandleResult.Seconds * 1000.0, PinResult.Seconds * 1000.0, PathResult.Seconds * 1000.0));
+    return true;
+}
+
+#if WITH_EDITOR
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlBenchmarkDerivedDataTest, "UnrealToml.Benchmark.DerivedData", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTomlBenchmarkDerivedDataTest::RunTest(const FString& Parameters)
+{
+    if (!GetDerivedDataCache())
+    {
+        AddInfo(TEXT("No derived data cache, skipping"));
+        return true;
+    }
+
+    // Every size is measured through the cache, whatever toml.DerivedData.MinSizeKB is set to
+    IConsoleVariable* MinSizeCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("toml.DerivedData.MinSizeKB"));
+    UTEST_NOT_NULL_EXPR(MinSizeCVar);
+    const int32 MinSizeKB = MinSizeCVar->GetInt();
+    ON_SCOPE_EXIT { MinSizeCVar->Set(MinSizeKB); };
+    MinSizeCVar->Set(0);
+
+    static constexpr int32 NumParses = 50;
+    static constexpr int64 ExpectedParseSum = static_cast<int64>(NumParses) * 42;
+    for (const int32 SizeKB : { 4, 32, 256 })
+    {
+        FString Content = TEXT("value = 42\n");
+        for (int32 Index = 0; Content.Len() < SizeKB * 1024; ++Index)
+        {
+            Content += FString::Printf(TEXT("[section%d]\nname = \"entry %d\"\nweights = [%d.5, 1.25, 3.0]\nenabled = true\n"), Index, Index, Index);
+        }
+        const FTCHARToUTF8 Utf8Content(*Content);
+        const std::string_view Utf8View(Utf8Content.Get(), Utf8Content.Length());
+        const uint64 ContentHash = Toml::HashContent(Utf8View);
+
+        const auto Parse = [Utf8View]()
+        {
+            toml::table Table;
+            FString Error;
+            return Toml::ParseTomlTable(Utf8View, Table, Error) ? Table["value"].value_or(int64(0)) : int64(0);
+        };
+        const auto ReadDerivedData = [Utf8View, ContentHash]()
+        {
+            toml::table Table;
+            FString Error;
+            return Toml::ParseTomlFile(Utf8View, ContentHash, Table, Error) ? Table["value"].value_or(int64(0)) : int64(0);
+        };
+        // The first read stores the entry, every measured read is a hit
+        UTEST_EQUAL_EXPR(ReadDerivedData(), int64(42));
+        const TomlBenchmark::FResult ParseResult = TomlBenchmark::Measure(Parse, NumParses);
+        const TomlBenchmark::FResult HitResult = TomlBenchmark::Measure(ReadDerivedData, NumParses);
+
+        UTEST_EQUAL(TEXT("Parse"), ParseResult.Sum, ExpectedParseSum);
+        UTEST_EQUAL(TEXT("Derived data cache hit"), HitResult.Sum, ExpectedParseSum);
+
+        AddInfo(FString::Printf(TEXT("%d x %d KB document: parse %.2f ms, derived data cache hit %.2f ms"),
+            NumParses, SizeKB, ParseResult.Seconds * 1000.0, HitResult.Seconds * 1000.0));
+    }
+    return true;
+}
+#endif
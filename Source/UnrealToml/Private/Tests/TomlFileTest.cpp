@@ -1,8 +1,21 @@
 #include "CoreMinimal.h"
+#include "HAL/FileManager.h"
 #include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "TomlFlatTable.h"
+#include "TomlPrivate.h"
 #include "UnrealToml.h"
 
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#endif
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileBasicTest, "UnrealToml.FTomlFile.Basic", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
 
 bool FTomlFileBasicTest::RunTest(const FString& Parameters)
@@ -63,6 +76,17 @@ bool FTomlFileBasicTest::RunTest(const FString& Parameters)
     UTEST_TRUE_EXPR(Toml.HasKey("title"));
     UTEST_FALSE_EXPR(Toml.HasKey("non_existent"));
     
+    // Narrow keys go to toml++ without conversion, and agree with the FString overloads
+    const FAnsiStringView IntegerKey("integer");
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(IntegerKey), Toml.Get<int32>(FString(TEXT("integer"))));
+    UTEST_EQUAL_EXPR(Toml.Get<FString>(UTF8TEXT("title")), TEXT("TOML Example"));
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(UTF8TEXT("non_existent"), 100), 100);
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<int32>(UTF8TEXT("array")), ExpectedInts);
+    UTEST_EQUAL_EXPR(Toml.AtPath<FString>(UTF8TEXT("table.key")), TEXT("value"));
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>("table.missing", -1), -1);
+    UTEST_TRUE_EXPR(Toml.HasKey(UTF8TEXT("table")));
+    UTEST_EQUAL_EXPR(Toml.GetTable(UTF8TEXT("table")).Get<FString>("key"), TEXT("value"));
+    
     return true;
 }
 
@@ -103,6 +127,883 @@ bool FTomlFileLoadTest::RunTest(const FString& Parameters)
     return true;
 }
 
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileMappedLoadTest, "UnrealToml.FTomlFile.MappedFileLoading", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileMappedLoadTest::RunTest(const FString& Parameters)
+{
+    const FString TestFilePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("UnrealToml/Source/UnrealToml/Private/Tests/TestFile.toml"));
+    
+    // Mapped loading must produce the same table as a regular load
+    FTomlTable Toml = FTomlTable::LoadFileMapped(TestFilePath);
+    UTEST_VALID_EXPR(Toml);
+    UTEST_EQUAL_EXPR(Toml.GetKeys(), FTomlTable::LoadFile(TestFilePath).GetKeys());
+    UTEST_EQUAL_EXPR(Toml.GetString("title"), TEXT("Test Config"));
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>("database.port"), 5432);
+    UTEST_EQUAL_EXPR(Toml.AtPathString("servers[1].name"), TEXT("backup"));
+    
+    // Missing files fail like LoadFile does
+    AddExpectedError(TEXT("Failed to read TOML file"), EAutomationExpectedErrorFlags::Contains);
+    FTomlTable Missing = FTomlTable::LoadFileMapped(FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("UnrealToml/NonExistent.toml")));
+    UTEST_INVALID_EXPR(Missing);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileAsyncLoadTest, "UnrealToml.FTomlFile.AsyncFileLoading", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileAsyncLoadTest::RunTest(const FString& Parameters)
+{
+    const FString TestFilePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("UnrealToml/Source/UnrealToml/Private/Tests/TestFile.toml"));
+    
+    TFuture<FTomlTable> Future = FTomlTable::LoadFileAsync(TestFilePath);
+    FTomlTable Toml = Future.Consume();
+    UTEST_VALID_EXPR(Toml);
+    UTEST_EQUAL_EXPR(Toml.GetString("title"), TEXT("Test Config"));
+    UTEST_EQUAL_EXPR(Toml.AtPath<bool>("settings.debug"), true);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileParallelLoadTest, "UnrealToml.FTomlFile.ParallelFileLoading", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileParallelLoadTest::RunTest(const FString& Parameters)
+{
+    const FString TestFilePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("UnrealToml/Source/UnrealToml/Private/Tests/TestFile.toml"));
+    const FString MissingFilePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("UnrealToml/NonExistent.toml"));
+    
+    AddExpectedError(TEXT("Failed to read TOML file"), EAutomationExpectedErrorFlags::Contains);
+    TArray<FTomlFileLoadResult> Results = FTomlTable::LoadFilesParallel({ TestFilePath, MissingFilePath, TestFilePath });
+    UTEST_EQUAL_EXPR(Results.Num(), 3);
+    
+    // Results keep input order with per-file errors
+    UTEST_EQUAL_EXPR(Results[0].FilePath, TestFilePath);
+    UTEST_VALID_EXPR(Results[0].Table);
+    UTEST_TRUE_EXPR(Results[0].Error.IsEmpty());
+    UTEST_EQUAL_EXPR(Results[0].Table.GetString("title"), TEXT("Test Config"));
+    
+    UTEST_EQUAL_EXPR(Results[1].FilePath, MissingFilePath);
+    UTEST_INVALID_EXPR(Results[1].Table);
+    UTEST_FALSE_EXPR(Results[1].Error.IsEmpty());
+    
+    UTEST_VALID_EXPR(Results[2].Table);
+    UTEST_EQUAL_EXPR(Results[2].Table.AtPath<int32>("database.port"), 5432);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileCookTest, "UnrealToml.FTomlFile.CookedFileLoading", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileCookTest::RunTest(const FString& Parameters)
+{
+    const FString TestFilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("CookTest.toml"));
+    const FString CookedFilePath = FTomlTable::GetCookedFilePath(TestFilePath);
+    const FString FlatFilePath = FTomlFlatTable::GetCookedFilePath(TestFilePath);
+    UTEST_TRUE_EXPR(FFileHelper::SaveStringToFile(TEXT("title = \"cooked\"\nvalues = [1, 2, 3]\n"), *TestFilePath));
+    
+    UTEST_TRUE_EXPR(FTomlTable::CookFile(TestFilePath));
+    UTEST_TRUE_EXPR(FPaths::FileExists(CookedFilePath));
+    UTEST_TRUE_EXPR(FPaths::FileExists(FlatFilePath));
+    
+    // The cooked file is loaded while it matches the source
+    FTomlTable Toml = FTomlTable::LoadFile(TestFilePath);
+    UTEST_VALID_EXPR(Toml);
+    UTEST_EQUAL_EXPR(Toml.GetString("title"), TEXT("cooked"));
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<int32>("values"), TArray<int32>({ 1, 2, 3 }));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFileMapped(TestFilePath).GetString("title"), TEXT("cooked"));
+    
+    // The flat file is mapped and read in place, its tables keep the mapping alive
+    {
+        FTomlFlatTable Values;
+        {
+            const FTomlFlatTable Flat = FTomlFlatTable::LoadFileMapped(TestFilePath);
+            UTEST_VALID_EXPR(Flat);
+            UTEST_EQUAL_EXPR(Flat.Get<FString>(TEXT("title")), TEXT("cooked"));
+            UTEST_EQUAL_EXPR(Flat.GetAllocatedSize(), static_cast<SIZE_T>(0));
+            Values = Flat;
+        }
+        const TArrayView<const int64> ValuesView = Values.GetHomoArrayView<int64>(TEXT("values"));
+        UTEST_EQUAL_EXPR(ValuesView.Num(), 3);
+        UTEST_EQUAL_EXPR(ValuesView[2], static_cast<int64>(3));
+    }
+    
+    // The cooked file is found without the source, as in a packaged build that only stages cooked files
+    const FString SourceBackupPath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("CookTest.toml.bak"));
+    UTEST_TRUE_EXPR(IFileManager::Get().Move(*SourceBackupPath, *TestFilePath));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFile(TestFilePath).GetString("title"), TEXT("cooked"));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFileMapped(TestFilePath).GetString("title"), TEXT("cooked"));
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFile(TestFilePath).Get<FString>(TEXT("title")), TEXT("cooked"));
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFileMapped(TestFilePath).Get<FString>(TEXT("title")), TEXT("cooked"));
+    UTEST_TRUE_EXPR(IFileManager::Get().Move(*TestFilePath, *SourceBackupPath));
+    
+    // Without a flat file the source is loaded instead
+    IFileManager::Get().Delete(*FlatFilePath);
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFileMapped(TestFilePath).Get<FString>(TEXT("title")), TEXT("cooked"));
+    
+    // Editing the source makes the cooked file stale, so the source is parsed instead
+    UTEST_TRUE_EXPR(FFileHelper::SaveStringToFile(TEXT("title = \"edited\"\n"), *TestFilePath));
+    Toml = FTomlTable::LoadFile(TestFilePath);
+    UTEST_VALID_EXPR(Toml);
+    UTEST_EQUAL_EXPR(Toml.GetString("title"), TEXT("edited"));
+    UTEST_FALSE_EXPR(Toml.HasKey("values"));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFileMapped(TestFilePath).GetString("title"), TEXT("edited"));
+    
+    // Same-size edits are detected as well, the cooked file is verified against the hash of the source
+    UTEST_TRUE_EXPR(FTomlTable::CookFile(TestFilePath));
+    UTEST_TRUE_EXPR(FFileHelper::SaveStringToFile(TEXT("title = \"edits!\"\n"), *TestFilePath));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFile(TestFilePath).GetString("title"), TEXT("edits!"));
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFile(TestFilePath).Get<FString>(TEXT("title")), TEXT("edits!"));
+    
+    // A cooked file of the current source is read, if it turns out corrupt the source is parsed instead
+    UTEST_TRUE_EXPR(FFileHelper::SaveStringToFile(TEXT("title = \"corrupt cook\"\n"), *TestFilePath));
+    UTEST_TRUE_EXPR(FTomlTable::CookFile(TestFilePath));
+    {
+        TArray<uint8> CookedContent;
+        UTEST_TRUE_EXPR(FFileHelper::LoadFileToArray(CookedContent, *CookedFilePath));
+        CookedContent.SetNum(CookedContent.Num() - 1);
+        UTEST_TRUE_EXPR(FFileHelper::SaveArrayToFile(CookedContent, *CookedFilePath));
+    }
+    AddExpectedError(TEXT("Ignoring corrupt cooked TOML file"), EAutomationExpectedErrorFlags::Contains);
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFile(TestFilePath).GetString("title"), TEXT("corrupt cook"));
+    
+    // Sources that fail to parse are not cooked
+    UTEST_TRUE_EXPR(FFileHelper::SaveStringToFile(TEXT("[invalid"), *TestFilePath));
+    AddExpectedError(TEXT("Failed to parse TOML file"), EAutomationExpectedErrorFlags::Contains);
+    UTEST_FALSE_EXPR(FTomlTable::CookFile(TestFilePath));
+    
+    IFileManager::Get().Delete(*TestFilePath);
+    IFileManager::Get().Delete(*CookedFilePath);
+    IFileManager::Get().Delete(*FlatFilePath);
+    return true;
+}
+
+#if WITH_EDITOR
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileDerivedDataTest, "UnrealToml.FTomlFile.DerivedData", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileDerivedDataTest::RunTest(const FString& Parameters)
+{
+    FDerivedDataCacheInterface* DerivedDataCache = GetDerivedDataCache();
+    if (!DerivedDataCache)
+    {
+        AddInfo(TEXT("No derived data cache, skipping"));
+        return true;
+    }
+
+    // FTomlFlatTable::LoadFile goes to the derived data cache without the parse cache in between.
+    // Every document is unique, so entries left by earlier runs are never hit, and entries are only ever added.
+    const FString TestFilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("DerivedDataTest.toml"));
+    const auto WriteUniqueFile = [&TestFilePath]()
+    {
+        const FString Content = FString::Printf(TEXT("id = \"%s\"\nvalue = 1\n"), *FGuid::NewGuid().ToString());
+        FFileHelper::SaveStringToFile(Content, *TestFilePath);
+        const FTCHARToUTF8 Utf8Content(*Content);
+        const std::string_view Utf8View(Utf8Content.Get(), Utf8Content.Length());
+        return Toml::BuildDerivedDataKey(Utf8View, Toml::HashContent(Utf8View));
+    };
+
+    // Files below the minimum size are parsed without looking at the cache
+    IConsoleVariable* MinSizeCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("toml.DerivedData.MinSizeKB"));
+    UTEST_NOT_NULL_EXPR(MinSizeCVar);
+    const int32 MinSizeKB = MinSizeCVar->GetInt();
+    ON_SCOPE_EXIT { MinSizeCVar->Set(MinSizeKB); };
+    MinSizeCVar->Set(1);
+    FString Key = WriteUniqueFile();
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFile(TestFilePath).Get<int32>(TEXT("value")), 1);
+    TArray<uint8> DerivedData;
+    UTEST_FALSE_EXPR(DerivedDataCache->GetSynchronous(*Key, DerivedData, TEXTVIEW("TOML")));
+    MinSizeCVar->Set(0);
+
+    // A miss parses the file and stores its binary form
+    Key = WriteUniqueFile();
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFile(TestFilePath).Get<int32>(TEXT("value")), 1);
+    UTEST_TRUE_EXPR(DerivedDataCache->GetSynchronous(*Key, DerivedData, TEXTVIEW("TOML")));
+    toml::table Stored;
+    FMemoryReader StoredReader(DerivedData);
+    UTEST_TRUE_EXPR(Toml::ReadBinary(StoredReader, Stored));
+    UTEST_EQUAL_EXPR(Stored["value"].value_or(int64(0)), int64(1));
+
+    // A hit is read instead of the file, shown by storing a different table under the key first
+    Key = WriteUniqueFile();
+    DerivedData.Reset();
+    FMemoryWriter Writer(DerivedData);
+    Toml::WriteBinary(Writer, toml::table{ { "value", 2 } });
+    DerivedDataCache->Put(*Key, DerivedData, TEXTVIEW("TOML"));
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFile(TestFilePath).Get<int32>(TEXT("value")), 2);
+
+    // A corrupt entry is ignored and the file parsed
+    Key = WriteUniqueFile();
+    DerivedData = { 0xFF, 0xFF, 0xFF, 0xFF };
+    DerivedDataCache->Put(*Key, DerivedData, TEXTVIEW("TOML"));
+    AddExpectedError(TEXT("Ignoring corrupt derived data"), EAutomationExpectedErrorFlags::Contains);
+    UTEST_EQUAL_EXPR(FTomlFlatTable::LoadFile(TestFilePath).Get<int32>(TEXT("value")), 1);
+
+    IFileManager::Get().Delete(*TestFilePath);
+    return true;
+}
+#endif
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileSharedDocumentTest, "UnrealToml.FTomlFile.SharedDocuments", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileSharedDocumentTest::RunTest(const FString& Parameters)
+{
+    const FString TestToml = TEXT(R"(
+        name = "shared"
+        
+        [table]
+        key = "value"
+        values = [1, 2, 3]
+    )");
+    
+    // Identical content loads from the parse cache and reads the same
+    FTomlTable First = FTomlTable::LoadString(TestToml);
+    FTomlTable Second = FTomlTable::LoadString(TestToml);
+    UTEST_VALID_EXPR(First);
+    UTEST_VALID_EXPR(Second);
+    UTEST_EQUAL_EXPR(Second.GetString("name"), First.GetString("name"));
+    UTEST_EQUAL_EXPR(Second.AtPathString("table.key"), TEXT("value"));
+    
+    // Subtables can be taken repeatedly and leave the parent intact
+    FTomlTable Table = First.GetTable("table");
+    FTomlTable TableAgain = First.GetTable("table");
+    UTEST_EQUAL_EXPR(Table.GetString("key"), TEXT("value"));
+    UTEST_EQUAL_EXPR(TableAgain.GetHomoArray<int32>("values"), TArray<int32>({ 1, 2, 3 }));
+    UTEST_EQUAL_EXPR(First.AtPathString("table.key"), TEXT("value"));
+    
+    // Subtables and copies keep the document alive after the tables they came from are gone
+    FTomlTable Copy = FTomlTable::LoadString(TEXT("[outer.inner]\nvalue = 42"));
+    FTomlTable Inner = Copy.GetTableAtPath("outer.inner");
+    Copy = FTomlTable::LoadString(TEXT("other = 1"));
+    UTEST_EQUAL_EXPR(Inner.GetInt("value"), 42);
+    UTEST_EQUAL_EXPR(Copy.GetInt("other"), 1);
+    
+    // Moving transfers the document and leaves the source invalid
+    FTomlTable Moved = MoveTemp(Inner);
+    UTEST_INVALID_EXPR(Inner);
+    UTEST_EQUAL_EXPR(Moved.GetInt("value"), 42);
+    Copy = MoveTemp(Moved);
+    UTEST_INVALID_EXPR(Moved);
+    UTEST_EQUAL_EXPR(Copy.GetInt("value"), 42);
+    FTomlTable InvalidCopy = Moved;
+    UTEST_INVALID_EXPR(InvalidCopy);
+    
+    // Containers relocate tables without touching their documents
+    TArray<FTomlTable> Tables;
+    for (int32 Index = 0; Index < 100; ++Index)
+    {
+        Tables.Add(FTomlTable::LoadString(FString::Printf(TEXT("index = %d"), Index)));
+    }
+    for (int32 Index = 0; Index < 100; ++Index)
+    {
+        UTEST_EQUAL_EXPR(Tables[Index].GetInt("index"), Index);
+    }
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileParseCacheTest, "UnrealToml.FTomlFile.ParseCache", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileParseCacheTest::RunTest(const FString& Parameters)
+{
+    IConsoleVariable* SizeCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("toml.ParseCache.SizeMB"));
+    UTEST_NOT_NULL_EXPR(SizeCVar);
+    const int32 SizeMB = SizeCVar->GetInt();
+    ON_SCOPE_EXIT { SizeCVar->Set(SizeMB); };
+    SizeCVar->Set(1);
+
+    // Each document holds a 400 KB string, so only two fit in the budget. Hashes are unique to this run.
+    int32 NumParses = 0;
+    const auto Parse = [&NumParses](toml::table& OutTable, FString& OutError)
+    {
+        ++NumParses;
+        OutTable.insert("text", std::string(400 * 1024, 'x'));
+        return true;
+    };
+    const auto MakeHash = []()
+    {
+        const FTCHARToUTF8 Guid(*FGuid::NewGuid().ToString());
+        return Toml::HashContent(std::string_view(Guid.Get(), Guid.Length()));
+    };
+    const uint64 FirstHash = MakeHash();
+    const uint64 SecondHash = MakeHash();
+    FString Error;
+    
+    // Hits need the content size to match as well as the hash
+    FTomlDocumentPtr First = Toml::FindOrParseDocument(FirstHash, 10, Parse, Error);
+    UTEST_EQUAL_EXPR(Toml::FindOrParseDocument(FirstHash, 10, Parse, Error), First);
+    UTEST_EQUAL_EXPR(NumParses, 1);
+    UTEST_NOT_EQUAL_EXPR(Toml::FindOrParseDocument(FirstHash, 11, Parse, Error), First);
+    UTEST_EQUAL_EXPR(NumParses, 2);
+    
+    // The least recently used document is evicted first
+    Toml::FindOrParseDocument(SecondHash, 10, Parse, Error);
+    Toml::FindOrParseDocument(FirstHash, 10, Parse, Error);
+    Toml::FindOrParseDocument(MakeHash(), 10, Parse, Error);
+    NumParses = 0;
+    UTEST_EQUAL_EXPR(Toml::FindOrParseDocument(FirstHash, 10, Parse, Error), First);
+    UTEST_EQUAL_EXPR(NumParses, 0);
+    Toml::FindOrParseDocument(SecondHash, 10, Parse, Error);
+    UTEST_EQUAL_EXPR(NumParses, 1);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileMemoryStatsTest, "UnrealToml.FTomlFile.MemoryStats", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileMemoryStatsTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT("short = \"a\"\nlong = \"a string too long to be stored inline\"\nvalues = [1, 2, 3]\n[table]\nkey = true"));
+    UTEST_VALID_EXPR(Toml);
+    
+    // Packed arrays count as indices once they are read
+    UTEST_EQUAL_EXPR(Toml.GetHomoArrayView<int64>("values").Num(), 3);
+    const FTomlMemoryStats Stats = Toml.GetAllocatedSize();
+    UTEST_TRUE_EXPR(Stats.NodeBytes > 0);
+    UTEST_TRUE_EXPR(Stats.KeyBytes > 0);
+    UTEST_TRUE_EXPR(Stats.StringBytes > 0);
+    UTEST_TRUE_EXPR(Stats.ContainerBytes > 0);
+    UTEST_TRUE_EXPR(Stats.IndexBytes > 0);
+    UTEST_TRUE_EXPR(Stats.SourceRegionBytes > 0);
+    UTEST_EQUAL_EXPR(Stats.GetTotal(), Stats.NodeBytes + Stats.KeyBytes + Stats.SourceRegionBytes + Stats.StringBytes + Stats.ContainerBytes + Stats.SourcePathBytes + Stats.IndexBytes);
+    
+    // Subtables report the document they share
+    UTEST_EQUAL_EXPR(Toml.GetTable("table").GetAllocatedSize().GetTotal(), Stats.GetTotal());
+    
+    UTEST_EQUAL_EXPR(FTomlTable::LoadString(TEXT("invalid = ")).GetAllocatedSize().GetTotal(), static_cast<SIZE_T>(0));
+    
+    // Lean tables have no table indices, the flat form also drops the source regions
+    FString LargeToml;
+    for (int32 Index = 0; Index < 32; ++Index)
+    {
+        LargeToml += FString::Printf(TEXT("key%d = %d\n"), Index, Index);
+    }
+    const FTomlTable Indexed = FTomlTable::LoadString(LargeToml);
+    const FTomlTable Lean = FTomlTable::LoadString(LargeToml, ETomlLoadOptions::Lean);
+    UTEST_EQUAL_EXPR(Lean.GetInt("key31"), 31);
+    UTEST_TRUE_EXPR(Indexed.GetAllocatedSize().IndexBytes > 0);
+    UTEST_EQUAL_EXPR(Lean.GetAllocatedSize().IndexBytes, static_cast<SIZE_T>(0));
+    UTEST_EQUAL_EXPR(Lean.GetAllocatedSize().SourceRegionBytes, Indexed.GetAllocatedSize().SourceRegionBytes);
+    UTEST_TRUE_EXPR(FTomlFlatTable::LoadString(LargeToml).GetAllocatedSize() < Lean.GetAllocatedSize().GetTotal() - Lean.GetAllocatedSize().SourceRegionBytes);
+    
+    // Lean documents are not shared, changing one leaves others alone
+    FTomlTable OtherLean = FTomlTable::LoadString(LargeToml, ETomlLoadOptions::Lean);
+    OtherLean.Set<int32>(TEXT("key0"), 100);
+    UTEST_EQUAL_EXPR(Lean.GetInt("key0"), 0);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileArchiveLoadTest, "UnrealToml.FTomlFile.ArchiveLoading", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileArchiveLoadTest::RunTest(const FString& Parameters)
+{
+    // Large enough to span several stream chunks, with a BOM and multi-byte characters
+    FString TestToml = TEXT("\uFEFFtitle = \"中文\"\n[entries]\n");
+    for (int32 Index = 0; Index < 10000; ++Index)
+    {
+        TestToml += FString::Printf(TEXT("key_%d = %d\n"), Index, Index);
+    }
+    
+    FTCHARToUTF8 Utf8Toml(*TestToml);
+    TArray<uint8> Bytes(reinterpret_cast<const uint8*>(Utf8Toml.Get()), Utf8Toml.Length());
+    FMemoryReader Reader(Bytes);
+    
+    FTomlTable Toml = FTomlTable::LoadArchive(Reader);
+    UTEST_VALID_EXPR(Toml);
+    UTEST_EQUAL_EXPR(Toml.GetString("title"), TEXT("中文"));
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>("entries.key_0"), 0);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>("entries.key_9999"), 9999);
+    
+    // Parse errors are reported like LoadString
+    TArray<uint8> InvalidBytes = { 'a', ' ', '=' };
+    FMemoryReader InvalidReader(InvalidBytes);
+    AddExpectedError(TEXT("Failed to parse TOML archive"), EAutomationExpectedErrorFlags::Contains);
+    UTEST_INVALID_EXPR(FTomlTable::LoadArchive(InvalidReader));
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileBinaryTest, "UnrealToml.FTomlFile.BinaryRoundTrip", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileBinaryTest::RunTest(const FString& Parameters)
+{
+    const FString TestToml = TEXT(R"(
+        title = "TOML Example"
+        integer = -42
+        float = 3.14
+        boolean = true
+        date = 1979-05-27
+        datetime = 1979-05-27T07:32:00-08:00
+        
+        ints = [1, 2, 3]
+        floats = [0.5, 1.5]
+        bools = [true, false, true]
+        strings = ["a", "中文", "👊🀄🔥"]
+        mixed = [1, "two", 3.0]
+        nested = [[1, 2], ["a"]]
+        empty = []
+        
+        [table]
+        key = "value"
+        
+        [[servers]]
+        name = "primary"
+        
+        [[servers]]
+        name = "backup"
+    )");
+    
+    FTomlTable Toml = FTomlTable::LoadString(TestToml);
+    UTEST_VALID_EXPR(Toml);
+    
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+    Writer << Toml;
+    
+    FMemoryReader Reader(Bytes);
+    FTomlTable Loaded = FTomlTable::LoadBinary(Reader);
+    UTEST_VALID_EXPR(Loaded);
+    UTEST_FALSE_EXPR(Reader.IsError());
+    
+    // Everything readable from the text form reads back the same from the binary form
+    UTEST_EQUAL_EXPR(Loaded.GetKeys(), Toml.GetKeys());
+    UTEST_EQUAL_EXPR(Loaded.GetString("title"), Toml.GetString("title"));
+    UTEST_EQUAL_EXPR(Loaded.GetInt("integer"), -42);
+    UTEST_EQUAL_EXPR(Loaded.GetFloat("float"), 3.14f);
+    UTEST_EQUAL_EXPR(Loaded.GetBool("boolean"), true);
+    UTEST_EQUAL_EXPR(Loaded.GetHomoArray<int64>("ints"), Toml.GetHomoArray<int64>("ints"));
+    UTEST_EQUAL_EXPR(Loaded.AtPath<double>("floats[1]"), 1.5);
+    UTEST_EQUAL_EXPR(Loaded.AtPath<bool>("bools[1]"), false);
+    UTEST_EQUAL_EXPR(Loaded.GetHomoArray<FString>("strings"), Toml.GetHomoArray<FString>("strings"));
+    UTEST_EQUAL_EXPR(Loaded.AtPathString("mixed[1]"), TEXT("two"));
+    UTEST_EQUAL_EXPR(Loaded.AtPath<double>("mixed[2]"), 3.0);
+    UTEST_EQUAL_EXPR(Loaded.AtPathInt("nested[0][1]"), 2);
+    UTEST_EQUAL_EXPR(Loaded.AtPathString("nested[1][0]"), TEXT("a"));
+    UTEST_TRUE_EXPR(Loaded.HasKey("date"));
+    UTEST_TRUE_EXPR(Loaded.HasKey("datetime"));
+    UTEST_TRUE_EXPR(Loaded.HasKey("empty"));
+    UTEST_EQUAL_EXPR(Loaded.AtPathString("table.key"), TEXT("value"));
+    UTEST_EQUAL_EXPR(Loaded.AtPathString("servers[1].name"), TEXT("backup"));
+    
+    // Re-serializing the loaded table is byte-identical
+    TArray<uint8> RoundTripBytes;
+    FMemoryWriter RoundTripWriter(RoundTripBytes);
+    RoundTripWriter << Loaded;
+    UTEST_EQUAL_EXPR(RoundTripBytes, Bytes);
+    
+    // Truncated data fails cleanly
+    TArray<uint8> Truncated(Bytes.GetData(), Bytes.Num() / 2);
+    FMemoryReader TruncatedReader(Truncated);
+    AddExpectedError(TEXT("Failed to load binary TOML table"), EAutomationExpectedErrorFlags::Contains);
+    UTEST_INVALID_EXPR(FTomlTable::LoadBinary(TruncatedReader));
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileFlatTest, "UnrealToml.FTomlFile.FlatTable", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileFlatTest::RunTest(const FString& Parameters)
+{
+    const FString TestToml = TEXT(R"(
+        title = "TOML Example"
+        integer = -42
+        float = 3.14
+        boolean = true
+        date = 1979-05-27
+        
+        ints = [1, 2, 3]
+        floats = [0.5, 1.5]
+        bools = [true, false, true]
+        strings = ["a", "中文", "👊🀄🔥"]
+        mixed = [1, "two", 3.0]
+        nested = [[1, 2], ["a"]]
+        empty = []
+        
+        [table]
+        key = "value"
+        
+        [[servers]]
+        name = "primary"
+        
+        [[servers]]
+        name = "backup"
+    )");
+    
+    FTomlTable Toml = FTomlTable::LoadString(TestToml);
+    UTEST_VALID_EXPR(Toml);
+    
+    TArray<uint8> Buffer;
+    FTomlFlatTable::Build(Toml, Buffer);
+    FTomlFlatTable Flat = FTomlFlatTable::FromBuffer(Buffer);
+    UTEST_VALID_EXPR(Flat);
+    UTEST_FALSE_EXPR(Flat.IsEmpty());
+    
+    // Queries against the flat view match the parsed table
+    UTEST_EQUAL_EXPR(Flat.GetKeys(), Toml.GetKeys());
+    UTEST_EQUAL_EXPR(Flat.Get<FString>("title"), Toml.GetString("title"));
+    UTEST_EQUAL_EXPR(Flat.Get<int32>("integer"), -42);
+    UTEST_EQUAL_EXPR(Flat.Get<float>("float"), 3.14f);
+    UTEST_EQUAL_EXPR(Flat.Get<bool>("boolean"), true);
+    UTEST_EQUAL_EXPR(Flat.Get<int32>("missing", 7), 7);
+    UTEST_EQUAL_EXPR(Flat.Get<int32>("title", 7), 7);
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<int64>("ints"), Toml.GetHomoArray<int64>("ints"));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<double>("floats"), Toml.GetHomoArray<double>("floats"));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<bool>("bools"), Toml.GetHomoArray<bool>("bools"));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<FString>("strings"), Toml.GetHomoArray<FString>("strings"));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<int32>("empty").Num(), 0);
+    UTEST_EQUAL_EXPR(Flat.AtPath<double>("floats[1]"), 1.5);
+    UTEST_EQUAL_EXPR(Flat.AtPath<bool>("bools[1]"), false);
+    UTEST_EQUAL_EXPR(Flat.AtPath<FString>("mixed[1]"), TEXT("two"));
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("nested[0][1]"), 2);
+    UTEST_EQUAL_EXPR(Flat.AtPath<FString>("nested[1][0]"), TEXT("a"));
+    UTEST_EQUAL_EXPR(Flat.AtPath<FString>("servers[1].name"), TEXT("backup"));
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("ints[3]", -1), -1);
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("ints[0].key", -1), -1);
+    UTEST_TRUE_EXPR(Flat.HasKey("date"));
+    UTEST_FALSE_EXPR(Flat.HasKey("missing"));
+    UTEST_EQUAL_EXPR(Flat.GetTable("table").Get<FString>("key"), TEXT("value"));
+    UTEST_EQUAL_EXPR(Flat.GetTableAtPath("servers[0]").Get<FString>("name"), TEXT("primary"));
+    
+    // Anything that is not a complete flat document is rejected
+    UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(TArrayView<const uint8>(Buffer.GetData(), Buffer.Num() / 2)));
+    TArray<uint8> Corrupt = Buffer;
+    Corrupt[0] ^= 0xFF;
+    UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(Corrupt));
+    UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(TArrayView<const uint8>()));
+    
+    // Owning tables keep their buffer alive independently of the source table
+    FTomlFlatTable Owned = FTomlFlatTable::FromTable(FTomlTable::LoadString(TEXT("[outer.inner]\nvalues = [4, 5]")));
+    UTEST_VALID_EXPR(Owned);
+    FTomlFlatTable Inner = Owned.GetTableAtPath("outer.inner");
+    Owned = FTomlFlatTable();
+    UTEST_EQUAL_EXPR(Inner.GetHomoArray<int32>("values"), TArray<int32>({ 4, 5 }));
+    UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(TArray<uint8>({ 1, 2, 3 })));
+    
+    // Lean loading reads the same as the parsed table
+    const FString TestFilePath = FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("UnrealToml/Source/UnrealToml/Private/Tests/TestFile.toml"));
+    FTomlFlatTable LeanFile = FTomlFlatTable::LoadFile(TestFilePath);
+    UTEST_VALID_EXPR(LeanFile);
+    UTEST_EQUAL_EXPR(LeanFile.GetKeys(), FTomlTable::LoadFile(TestFilePath).GetKeys());
+    UTEST_EQUAL_EXPR(LeanFile.AtPath<int32>("database.port"), 5432);
+    UTEST_EQUAL_EXPR(FTomlTable::LoadFile(TestFilePath, ETomlLoadOptions::Lean).AtPath<int32>("database.port"), 5432);
+    FTomlFlatTable LeanString = FTomlFlatTable::LoadString(TestToml);
+    UTEST_VALID_EXPR(LeanString);
+    UTEST_EQUAL_EXPR(LeanString.AtPath<FString>("servers[1].name"), TEXT("backup"));
+    AddExpectedError(TEXT("Failed to parse TOML string"), EAutomationExpectedErrorFlags::Contains);
+    UTEST_INVALID_EXPR(FTomlFlatTable::LoadString(TEXT("[invalid")));
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileFlatEncodingTest, "UnrealToml.FTomlFile.FlatEncoding", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileFlatEncodingTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT(R"(
+        min = -9223372036854775808
+        max = 9223372036854775807
+        zero = 0
+        negative = -0.25
+        huge = 1e300
+        no = false
+        yes = true
+        empty = ""
+        short = "abc"
+        long = "a string well past any inline capacity, 中文 and 👊🀄🔥 included"
+        ints = [-9223372036854775808, 0, 9223372036854775807]
+        floats = [-0.25, 1e300]
+        bools = [false, true, false]
+        mixed = [false, -7, 2.5, "four", [5], { six = 6 }]
+
+        [child]
+        no = false
+        long = "another string well past any inline capacity"
+    )"));
+    UTEST_VALID_EXPR(Toml);
+
+    TArray<uint8> Buffer;
+    FTomlFlatTable::Build(Toml, Buffer);
+    FTomlFlatTable Flat = FTomlFlatTable::FromBuffer(Buffer);
+    UTEST_VALID_EXPR(Flat);
+
+    // Scalars stored inline in their entry keep every bit
+    UTEST_EQUAL_EXPR(Flat.Get<int64>("min"), MIN_int64);
+    UTEST_EQUAL_EXPR(Flat.Get<int64>("max"), MAX_int64);
+    UTEST_EQUAL_EXPR(Flat.Get<int64>("zero", 1), int64(0));
+    UTEST_EQUAL_EXPR(Flat.Get<double>("negative"), -0.25);
+    UTEST_EQUAL_EXPR(Flat.Get<double>("huge"), 1e300);
+    UTEST_EQUAL_EXPR(Flat.Get<bool>("no", true), false);
+    UTEST_EQUAL_EXPR(Flat.Get<bool>("yes", false), true);
+    UTEST_EQUAL_EXPR(Flat.AtPath<bool>("child.no", true), false);
+    // An inline value is only read as its own type
+    UTEST_EQUAL_EXPR(Flat.Get<int64>("no", 7), int64(7));
+    UTEST_EQUAL_EXPR(Flat.Get<double>("max", 7.0), 7.0);
+    UTEST_EQUAL_EXPR(Flat.Get<bool>("zero", true), true);
+
+    // Strings and arrays are stored out of line, behind the offset in their entry
+    UTEST_EQUAL_EXPR(Flat.Get<FString>("empty", TEXT("default")), FString());
+    UTEST_EQUAL_EXPR(Flat.Get<FString>("short"), TEXT("abc"));
+    UTEST_EQUAL_EXPR(Flat.Get<FString>("long"), Toml.GetString("long"));
+    UTEST_EQUAL_EXPR(Flat.AtPath<FString>("child.long"), Toml.AtPath<FString>("child.long"));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<int64>("ints"), TArray<int64>({ MIN_int64, 0, MAX_int64 }));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<double>("floats"), TArray<double>({ -0.25, 1e300 }));
+    UTEST_EQUAL_EXPR(Flat.GetHomoArray<bool>("bools"), TArray<bool>({ false, true, false }));
+    TArrayView<const int64> IntsView = Flat.GetHomoArrayView<int64>("ints");
+    UTEST_EQUAL_EXPR(IntsView.Num(), 3);
+    UTEST_TRUE_EXPR(reinterpret_cast<const uint8*>(IntsView.GetData()) > Buffer.GetData()
+        && reinterpret_cast<const uint8*>(IntsView.GetData() + IntsView.Num()) <= Buffer.GetData() + Buffer.Num());
+
+    // Elements of a mixed array are values too, each read through its own tag
+    UTEST_EQUAL_EXPR(Flat.AtPath<bool>("mixed[0]", true), false);
+    UTEST_EQUAL_EXPR(Flat.AtPath<int64>("mixed[1]"), int64(-7));
+    UTEST_EQUAL_EXPR(Flat.AtPath<double>("mixed[2]"), 2.5);
+    UTEST_EQUAL_EXPR(Flat.AtPath<FString>("mixed[3]"), TEXT("four"));
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("mixed[4][0]"), 5);
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("mixed[5].six"), 6);
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("mixed[2]", -1), -1);
+    UTEST_EQUAL_EXPR(Flat.AtPath<int32>("mixed[6]", -1), -1);
+
+    // Buffers of another layout version or without the magic are rejected rather than misread
+    uint32 StoredMagic = 0;
+    uint32 StoredVersion = 0;
+    FMemory::Memcpy(&StoredMagic, Buffer.GetData(), sizeof(uint32));
+    FMemory::Memcpy(&StoredVersion, Buffer.GetData() + sizeof(uint32), sizeof(uint32));
+    UTEST_EQUAL_EXPR(StoredMagic, Toml::Flat::Magic);
+    UTEST_EQUAL_EXPR(StoredVersion, Toml::Flat::Version);
+
+    for (const uint32 OtherVersion : { 0u, Toml::Flat::Version - 1, Toml::Flat::Version + 1 })
+    {
+        TArray<uint8> OtherVersionBuffer = Buffer;
+        FMemory::Memcpy(OtherVersionBuffer.GetData() + sizeof(uint32), &OtherVersion, sizeof(uint32));
+        UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(OtherVersionBuffer));
+        UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(MoveTemp(OtherVersionBuffer)));
+    }
+
+    TArray<uint8> OtherMagicBuffer = Buffer;
+    const uint32 ByteSwappedMagic = BYTESWAP_ORDER32(Toml::Flat::Magic);
+    FMemory::Memcpy(OtherMagicBuffer.GetData(), &ByteSwappedMagic, sizeof(uint32));
+    UTEST_INVALID_EXPR(FTomlFlatTable::FromBuffer(OtherMagicBuffer));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileWideTableTest, "UnrealToml.FTomlFile.WideTables", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileWideTableTest::RunTest(const FString& Parameters)
+{
+    // Wide tables are looked up through a hash index, narrow ones directly
+    FString TestToml = TEXT("narrow = 1\n[items]\n");
+    for (int32 Index = 0; Index < 2000; ++Index)
+    {
+        TestToml += FString::Printf(TEXT("item_%d = %d\n"), Index, Index * 2);
+    }
+    TestToml += TEXT("[[rows]]\n");
+    for (int32 Index = 0; Index < 32; ++Index)
+    {
+        TestToml += FString::Printf(TEXT("column_%d = \"%d\"\n"), Index, Index);
+    }
+    
+    FTomlTable Toml = FTomlTable::LoadString(TestToml);
+    UTEST_VALID_EXPR(Toml);
+    UTEST_EQUAL_EXPR(Toml.GetInt("narrow"), 1);
+    
+    FTomlTable Items = Toml.GetTable("items");
+    for (int32 Index = 0; Index < 2000; ++Index)
+    {
+        const FString Key = FString::Printf(TEXT("item_%d"), Index);
+        UTEST_TRUE_EXPR(Items.HasKey(Key));
+        UTEST_EQUAL_EXPR(Items.GetInt(Key), Index * 2);
+    }
+    UTEST_FALSE_EXPR(Items.HasKey("item_2000"));
+    UTEST_EQUAL_EXPR(Items.GetInt("item_2000", -1), -1);
+    UTEST_EQUAL_EXPR(Items.GetString("item_1", TEXT("default")), TEXT("default"));
+    
+    // Iteration keeps the sorted key order
+    TArray<FString> Keys = Items.GetKeys();
+    UTEST_EQUAL_EXPR(Keys.Num(), 2000);
+    UTEST_EQUAL_EXPR(Keys[0], TEXT("item_0"));
+    UTEST_EQUAL_EXPR(Keys[1], TEXT("item_1"));
+    UTEST_EQUAL_EXPR(Keys[2], TEXT("item_10"));
+    
+    // Tables inside arrays are indexed too
+    FTomlTable Row = Toml.GetTableAtPath("rows[0]");
+    UTEST_EQUAL_EXPR(Row.GetString("column_31"), TEXT("31"));
+    UTEST_FALSE_EXPR(Row.HasKey("column_32"));
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFilePackedArrayTest, "UnrealToml.FTomlFile.PackedArrays", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFilePackedArrayTest::RunTest(const FString& Parameters)
+{
+    FString Curve = TEXT("curve = [");
+    for (int32 Index = 0; Index < 1000; ++Index)
+    {
+        Curve += FString::Printf(TEXT("%d.5, "), Index);
+    }
+    Curve += TEXT("]\nids = [3, 1, 2]\nmixed = [1, 2.0]\nempty = []\nnested = [[4, 5]]\n");
+    
+    FTomlTable Toml = FTomlTable::LoadString(Curve);
+    UTEST_VALID_EXPR(Toml);
+    
+    // Arrays are only packed once they are viewed, copying them out leaves no packed copy behind
+    const SIZE_T UnreadIndexBytes = Toml.GetAllocatedSize().IndexBytes;
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<double>("curve").Num(), 1000);
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<int32>("ids"), TArray<int32>({ 3, 1, 2 }));
+    UTEST_EQUAL_EXPR(Toml.GetAllocatedSize().IndexBytes, UnreadIndexBytes);
+    TArrayView<const double> CurveView = Toml.GetHomoArrayView<double>("curve");
+    UTEST_TRUE_EXPR(Toml.GetAllocatedSize().IndexBytes >= UnreadIndexBytes + 1000 * sizeof(double));
+    UTEST_EQUAL_EXPR(CurveView.Num(), 1000);
+    UTEST_EQUAL_EXPR(CurveView[999], 999.5);
+    UTEST_EQUAL_EXPR(Toml.GetHomoArrayView<double>("curve").GetData(), CurveView.GetData());
+    UTEST_EQUAL_EXPR(Toml.GetHomoArrayView<int64>("ids")[0], 3);
+    UTEST_EQUAL_EXPR(Toml.GetHomoArrayView<int64>("empty").Num(), 0);
+    
+    // Empty arrays are empty for every element type, viewed or copied
+    UTEST_EQUAL_EXPR(Toml.GetHomoArrayView<double>("empty").Num(), 0);
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<int32>("empty").Num(), 0);
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<FString>("empty").Num(), 0);
+    
+    // Copies out of the packed arrays, converting to the narrower types
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<int32>("ids"), TArray<int32>({ 3, 1, 2 }));
+    UTEST_EQUAL_EXPR(Toml.GetHomoArray<float>("curve")[1], 1.5f);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>("nested[0][1]"), 5);
+    
+    // Replacing an array drops its packed copy
+    Toml.Set<int32>(TEXT("ids"), 0);
+    UTEST_EQUAL_EXPR(Toml.GetInt("ids"), 0);
+    
+    // Flat buffers keep the same arrays packed
+    FTomlFlatTable Flat = FTomlFlatTable::FromTable(Toml);
+    UTEST_EQUAL_EXPR(Flat.GetHomoArrayView<double>("curve").Num(), 1000);
+    UTEST_EQUAL_EXPR(Flat.GetHomoArrayView<double>("curve")[10], 10.5);
+    UTEST_EQUAL_EXPR(Flat.GetHomoArrayView<int64>("empty").Num(), 0);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileCopyOnWriteTest, "UnrealToml.FTomlFile.CopyOnWrite", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileCopyOnWriteTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Original = FTomlTable::LoadString(TEXT("name = \"original\"\ncount = 1\n[nested]\nvalue = 2"));
+    UTEST_VALID_EXPR(Original);
+    
+    // Changing a copy leaves the original and its cached document untouched
+    FTomlTable Copy = Original;
+    Copy.Set<FString>("name", TEXT("copy"));
+    Copy.Set("count", 10);
+    Copy.Set("ratio", 0.5);
+    Copy.Set("enabled", true);
+    UTEST_EQUAL_EXPR(Copy.GetString("name"), TEXT("copy"));
+    UTEST_EQUAL_EXPR(Copy.GetInt("count"), 10);
+    UTEST_EQUAL_EXPR(Copy.Get<double>("ratio"), 0.5);
+    UTEST_EQUAL_EXPR(Copy.GetBool("enabled"), true);
+    UTEST_EQUAL_EXPR(Original.GetString("name"), TEXT("original"));
+    UTEST_EQUAL_EXPR(Original.GetInt("count"), 1);
+    UTEST_FALSE_EXPR(Original.HasKey("ratio"));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadString(TEXT("name = \"original\"\ncount = 1\n[nested]\nvalue = 2")).GetInt("count"), 1);
+    
+    // The first change copies a loaded document away from the parse cache, later ones change the copy in place
+    const TCHAR* LoadedContent = TEXT("ids = [1, 2, 3]\nname = \"loaded\"");
+    FTomlTable Loaded = FTomlTable::LoadString(LoadedContent);
+    const FTomlTable Cached = FTomlTable::LoadString(LoadedContent);
+    Loaded.Set("count", 1);
+    UTEST_FALSE_EXPR(Cached.HasKey("count"));
+    const TArrayView<const int64> Ids = Loaded.GetHomoArrayView<int64>("ids");
+    Loaded.Set("count", 2);
+    Loaded.Set<FString>("name", TEXT("changed"));
+    UTEST_EQUAL_EXPR(Loaded.GetHomoArrayView<int64>("ids").GetData(), Ids.GetData());
+    UTEST_EQUAL_EXPR(Ids[2], static_cast<int64>(3));
+    UTEST_EQUAL_EXPR(Loaded.GetInt("count"), 2);
+    UTEST_EQUAL_EXPR(Cached.GetString("name"), TEXT("loaded"));
+    UTEST_EQUAL_EXPR(FTomlTable::LoadString(LoadedContent).GetString("name"), TEXT("loaded"));
+    
+    // Values can change type and be removed
+    UTEST_TRUE_EXPR(Copy.Remove("nested"));
+    UTEST_FALSE_EXPR(Copy.Remove("nested"));
+    UTEST_FALSE_EXPR(Original.Remove("missing"));
+    UTEST_FALSE_EXPR(Copy.HasKey("nested"));
+    UTEST_EQUAL_EXPR(Original.AtPathInt("nested.value"), 2);
+    Copy.Set<FString>("count", TEXT("ten"));
+    UTEST_EQUAL_EXPR(Copy.GetString("count"), TEXT("ten"));
+    
+    // Subtables taken earlier keep seeing the document they were taken from
+    FTomlTable Nested = Original.GetTable("nested");
+    Nested.Set("value", 3);
+    UTEST_EQUAL_EXPR(Nested.GetInt("value"), 3);
+    UTEST_EQUAL_EXPR(Original.AtPathInt("nested.value"), 2);
+    
+    // Tables growing past the indexing threshold, and shrinking again, stay searchable
+    for (int32 Index = 0; Index < 100; ++Index)
+    {
+        Copy.Set(FString::Printf(TEXT("key_%d"), Index), Index);
+    }
+    for (int32 Index = 0; Index < 100; Index += 2)
+    {
+        UTEST_TRUE_EXPR(Copy.Remove(FString::Printf(TEXT("key_%d"), Index)));
+    }
+    for (int32 Index = 0; Index < 100; ++Index)
+    {
+        UTEST_EQUAL_EXPR(Copy.GetInt(FString::Printf(TEXT("key_%d"), Index), -1), Index % 2 ? Index : -1);
+    }
+    UTEST_EQUAL_EXPR(Copy.GetString("name"), TEXT("copy"));
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileNameLookupTest, "UnrealToml.FTomlFile.NameLookups", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileNameLookupTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT("speed = 4.5\nname = \"hero\"\nLevel = 1\nlevel = 2\n[stats]\nhealth = 100\n[stats.regen]\nrate = 0.5"));
+    UTEST_VALID_EXPR(Toml);
+    
+    const FName Speed(TEXT("speed"));
+    UTEST_TRUE_EXPR(Toml.HasKey(Speed));
+    UTEST_FALSE_EXPR(Toml.HasKey(FName(TEXT("missing"))));
+    UTEST_EQUAL_EXPR(Toml.Get<double>(Speed), 4.5);
+    UTEST_EQUAL_EXPR(Toml.Get<FString>(FName(TEXT("name"))), TEXT("hero"));
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(FName(TEXT("missing")), 7), 7);
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(Speed, 7), 7);
+    
+    // Keys are case sensitive like with string lookups, although names ignore case
+#if WITH_CASE_PRESERVING_NAME
+    UTEST_FALSE_EXPR(Toml.HasKey(FName(TEXT("NAME"))));
+    UTEST_EQUAL_EXPR(Toml.Get<FString>(FName(TEXT("NAME")), TEXT("none")), TEXT("none"));
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(FName(TEXT("Level"))), 1);
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(FName(TEXT("level"))), 2);
+    UTEST_FALSE_EXPR(Toml.HasKey(FName(TEXT("LEVEL"))));
+#else
+    // Names that differ only by case are one name here, which finds the key spelled like the name table spells it
+    const FName UpperName(TEXT("NAME"));
+    UTEST_EQUAL_EXPR(Toml.HasKey(UpperName), UpperName.ToString().Equals(TEXT("name"), ESearchCase::CaseSensitive));
+#endif
+    
+    // Path segments walk subtables
+    const FName RegenRate[] = { FName(TEXT("stats")), FName(TEXT("regen")), FName(TEXT("rate")) };
+    UTEST_EQUAL_EXPR(Toml.AtPath<double>(RegenRate), 0.5);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>({ FName(TEXT("stats")), FName(TEXT("health")) }), 100);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>({ FName(TEXT("stats")), FName(TEXT("mana")) }, -1), -1);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>({ Speed, FName(TEXT("health")) }, -1), -1);
+    
+    // Mutations are visible to later name lookups, including of names that found no key before
+    const FName Added(TEXT("added"));
+    UTEST_FALSE_EXPR(Toml.HasKey(Added));
+    Toml.Set<int32>(TEXT("speed"), 9);
+    Toml.Set<int32>(TEXT("added"), 3);
+    Toml.Remove(TEXT("name"));
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(Speed), 9);
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(Added), 3);
+    UTEST_FALSE_EXPR(Toml.HasKey(FName(TEXT("name"))));
+    
+    // String keys keep resolving to the FString overloads
+    UTEST_EQUAL_EXPR(Toml.Get<int32>("Level"), 1);
+    UTEST_EQUAL_EXPR(Toml.Get<int32>(TEXT("level")), 2);
+    UTEST_TRUE_EXPR(Toml.HasKey(FName(TEXT("level"))));
+    
+    return true;
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFilePathTest, "UnrealToml.FTomlFile.PathAccess", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
 
 bool FTomlFilePathTest::RunTest(const FString& Parameters)
@@ -142,6 +1043,130 @@ bool FTomlFilePathTest::RunTest(const FString& Parameters)
     UTEST_EQUAL_EXPR(DbTable.GetString("host"), TEXT("db1.example.com"));
     UTEST_EQUAL_EXPR(DbTable.GetInt("port"), 5432);
     
+    // Precompiled paths resolve like their strings
+    const FTomlPath PrimaryPort(TEXT("database.primary.port"));
+    UTEST_TRUE_EXPR(PrimaryPort.IsValid());
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(PrimaryPort), 5432);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(FTomlPath(TEXT("array_table.numbers[2]"))), 3);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(FTomlPath(TEXT("array_table.numbers[3]")), -1), -1);
+    UTEST_EQUAL_EXPR(Toml.AtPath<FString>(FTomlPath(TEXT("server.port")), TEXT("default")), TEXT("default"));
+    UTEST_EQUAL_EXPR(Toml.GetTableAtPath(FTomlPath(TEXT("database.primary"))).GetString("host"), TEXT("db1.example.com"));
+    UTEST_EQUAL_EXPR(DbTable.AtPath<int32>(FTomlPath(TEXT("port"))), 5432);
+    
+    const FTomlPath InvalidPath(TEXT("server..[x"));
+    UTEST_FALSE_EXPR(InvalidPath.IsValid());
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(InvalidPath, -1), -1);
+    
+    // Keys of wide tables are looked up with the precomputed hash
+    FString WideToml = TEXT("[wide]\n");
+    for (int32 Index = 0; Index < 64; ++Index)
+    {
+        WideToml += FString::Printf(TEXT("key_%d = %d\n"), Index, Index);
+    }
+    FTomlTable Wide = FTomlTable::LoadString(WideToml);
+    UTEST_EQUAL_EXPR(Wide.AtPath<int32>(FTomlPath(TEXT("wide.key_63"))), 63);
+    UTEST_EQUAL_EXPR(Wide.AtPath<int32>(FTomlPath(TEXT("wide.key_64")), -1), -1);
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileOptionalTest, "UnrealToml.FTomlFile.OptionalAccess", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileOptionalTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT("name = \"hero\"\nlevel = 3\nspeed = 4.5\n[stats]\nhealth = 100\nresists = [\"fire\", \"ice\"]"));
+    UTEST_VALID_EXPR(Toml);
+    
+    const TOptional<FString> Name = Toml.TryGet<FString>(TEXT("name"));
+    UTEST_TRUE_EXPR(Name.IsSet());
+    UTEST_EQUAL_EXPR(Name.GetValue(), TEXT("hero"));
+    UTEST_EQUAL_EXPR(Toml.TryGet<int32>("level").Get(-1), 3);
+    UTEST_FALSE_EXPR(Toml.TryGet<int32>(TEXT("missing")).IsSet());
+    
+    // Values of another type are not converted
+    UTEST_FALSE_EXPR(Toml.TryGet<int32>("speed").IsSet());
+    UTEST_FALSE_EXPR(Toml.TryGet<FString>(UTF8TEXT("level")).IsSet());
+    
+    // The out parameter is only written on success
+    double Speed = -1.0;
+    UTEST_TRUE_EXPR(Toml.TryGet(TEXT("speed"), Speed));
+    UTEST_EQUAL_EXPR(Speed, 4.5);
+    FString Missing = TEXT("unchanged");
+    UTEST_FALSE_EXPR(Toml.TryGet("missing", Missing));
+    UTEST_EQUAL_EXPR(Missing, TEXT("unchanged"));
+    
+    // Path variants
+    UTEST_EQUAL_EXPR(Toml.TryAtPath<int32>(TEXT("stats.health")).Get(-1), 100);
+    UTEST_EQUAL_EXPR(Toml.TryAtPath<FString>("stats.resists[1]").Get(TEXT("")), TEXT("ice"));
+    UTEST_FALSE_EXPR(Toml.TryAtPath<FString>("stats.resists[2]").IsSet());
+    int32 Health = 0;
+    UTEST_TRUE_EXPR(Toml.TryAtPath(FTomlPath(TEXT("stats.health")), Health));
+    UTEST_EQUAL_EXPR(Health, 100);
+    UTEST_FALSE_EXPR(Toml.TryAtPath<int32>(FTomlPath(TEXT("stats.mana"))).IsSet());
+    
+    // The defaulted getters share the same lookup
+    UTEST_EQUAL_EXPR(Toml.AtPath<FString>("stats.health", TEXT("default")), TEXT("default"));
+    UTEST_EQUAL_EXPR(Toml.AtPath<FString>("name", TEXT("default")), TEXT("hero"));
+    
+    // Invalid tables give the default or nothing instead of failing
+    AddExpectedError(TEXT("Failed to parse TOML string"), EAutomationExpectedErrorFlags::Contains);
+    const FTomlTable Invalid = FTomlTable::LoadString(TEXT("[invalid"));
+    UTEST_INVALID_EXPR(Invalid);
+    UTEST_EQUAL_EXPR(Invalid.Get<int32>(TEXT("level"), -1), -1);
+    UTEST_EQUAL_EXPR(Invalid.AtPath<int32>(TEXT("stats.health"), -1), -1);
+    UTEST_EQUAL_EXPR(Invalid.AtPath<double>("stats.health", -1.0), -1.0);
+    UTEST_EQUAL_EXPR(Invalid.AtPath<bool>(UTF8TEXT("stats.health"), true), true);
+    UTEST_EQUAL_EXPR(Invalid.AtPath<FString>(TEXT("name"), TEXT("default")), TEXT("default"));
+    UTEST_EQUAL_EXPR(Invalid.AtPath<int32>(FTomlPath(TEXT("stats.health")), -1), -1);
+    UTEST_FALSE_EXPR(Invalid.TryAtPath<int32>(TEXT("stats.health")).IsSet());
+    
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTomlFileValueHandleTest, "UnrealToml.FTomlFile.ValueHandles", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FTomlFileValueHandleTest::RunTest(const FString& Parameters)
+{
+    FTomlTable Toml = FTomlTable::LoadString(TEXT("name = \"hero\"\nspeed = 4.5\n[stats]\nhealth = 100\nresists = [\"fire\", \"ice\"]"));
+    UTEST_VALID_EXPR(Toml);
+    // Loaded documents are shared with the parse cache, the first change gives the table a document of its own
+    Toml.Set<int32>(TEXT("level"), 1);
+    
+    const FTomlValueHandle Speed = Toml.GetHandle(TEXT("speed"));
+    const FTomlValueHandle Health = Toml.GetHandleAtPath(TEXT("stats.health"));
+    const FTomlValueHandle Resist = Toml.GetHandleAtPath(FTomlPath(TEXT("stats.resists[1]")));
+    UTEST_TRUE_EXPR(Speed.IsValid());
+    UTEST_EQUAL_EXPR(Speed.Get<float>(), 4.5f);
+    UTEST_EQUAL_EXPR(Health.Get<int32>(), 100);
+    UTEST_EQUAL_EXPR(Resist.Get<FString>(), TEXT("ice"));
+    
+    // Reads check the type like the table getters
+    UTEST_EQUAL_EXPR(Health.Get<double>(-1.0), -1.0);
+    UTEST_FALSE_EXPR(Speed.TryGet<FString>().IsSet());
+    
+    // Missing values give invalid handles
+    const FTomlValueHandle Missing = Toml.GetHandleAtPath(TEXT("stats.mana"));
+    UTEST_FALSE_EXPR(Missing.IsValid());
+    UTEST_FALSE_EXPR(FTomlValueHandle().IsValid());
+    UTEST_EQUAL_EXPR(Missing.Get<int32>(-1), -1);
+    
+    // A change to the document invalidates its handles
+    Toml.Set<int32>(TEXT("level"), 2);
+    UTEST_FALSE_EXPR(Speed.IsValid());
+    UTEST_FALSE_EXPR(Health.TryGet<int32>().IsSet());
+    const FTomlValueHandle NewSpeed = Toml.GetHandle(TEXT("speed"));
+    UTEST_EQUAL_EXPR(NewSpeed.Get<double>(), 4.5);
+    
+    // A copy-on-write change leaves handles to the shared document valid
+    FTomlTable Copy = Toml;
+    Copy.Set<double>(TEXT("speed"), 9.0);
+    UTEST_EQUAL_EXPR(NewSpeed.Get<double>(), 4.5);
+    
+    // Handles do not keep the document alive
+    Toml = FTomlTable::LoadString(TEXT(""));
+    UTEST_TRUE_EXPR(Copy.GetHandle(TEXT("speed")).IsValid());
+    UTEST_FALSE_EXPR(NewSpeed.IsValid());
+    
     return true;
 }
 
@@ -173,6 +1198,20 @@ bool FTomlFileTypeConversionTest::RunTest(const FString& Parameters)
     UTEST_EQUAL_EXPR(Toml.GetBool("float_value", false), false);
     UTEST_EQUAL_EXPR(Toml.GetInt("float_value", -1), -1);
     
+    // Integers and floats are not converted into each other, whichever overload looks them up
+    UTEST_EQUAL_EXPR(Toml.GetFloat("int_value", -1.0), -1.0);
+    UTEST_EQUAL_EXPR(Toml.AtPath<float>(TEXT("int_value"), -1.0f), -1.0f);
+    UTEST_EQUAL_EXPR(Toml.AtPath<double>("int_value", -1.0), -1.0);
+    UTEST_EQUAL_EXPR(Toml.AtPath<float>(FTomlPath(TEXT("int_value")), -1.0f), -1.0f);
+    UTEST_EQUAL_EXPR(Toml.AtPath<float>(TArrayView<const FName>({ FName(TEXT("int_value")) }), -1.0f), -1.0f);
+    UTEST_EQUAL_EXPR(Toml.AtPathFloat(TEXT("int_value"), -1.0), -1.0);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(TEXT("float_value"), -1), -1);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int64>("float_value", -1), int64(-1));
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(FTomlPath(TEXT("float_value")), -1), -1);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(TArrayView<const FName>({ FName(TEXT("float_value")) }), -1), -1);
+    UTEST_EQUAL_EXPR(Toml.AtPath<float>(TEXT("float_value"), -1.0f), 3.14f);
+    UTEST_EQUAL_EXPR(Toml.AtPath<int32>(FTomlPath(TEXT("int_value")), -1), 42);
+    
     return true;
 }
 
@@ -0,0 +1,546 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+#include "Serialization/Archive.h"
+
+#include <unordered_map>
+
+// Binary layout, all integers in archive byte order:
+//
+//   Document := uint32 Magic, uint32 Version, int32 NumKeys, NumKeys x String, Table
+//   Node     := uint8 node_type, Payload
+//   Table    := int32 NumEntries, NumEntries x (int32 KeyIndex, Node)
+//   Array    := int32 NumElements, uint8 ElementType, Elements
+//   String   := int32 NumBytes, NumBytes x UTF-8 byte
+//
+// Keys are interned into the document-wide key list and referenced by index. Homogeneous arrays store
+// ElementType once and untagged payloads, with integer, float and boolean arrays packed so they are
+// read and written with a single bulk copy. Heterogeneous arrays use ElementType none and tagged nodes.
+namespace Toml
+{
+    static constexpr uint32 BinaryMagic = 0x424D4F54; // 'TOMB'
+    static constexpr uint32 BinaryVersion = 1;
+
+    template<typename T>
+    void SerializePacked(FArchive& Ar, TArray<T>& Values)
+    {
+        if (Ar.IsByteSwapping())
+        {
+            for (T& Value : Values)
+            {
+                Ar << Value;
+            }
+        }
+        else
+        {
+            Ar.Serialize(Values.GetData(), Values.Num() * sizeof(T));
+        }
+    }
+
+    class FBinaryWriter
+    {
+    public:
+        explicit FBinaryWriter(FArchive& InAr)
+            : Ar(InAr)
+        {
+        }
+
+        void WriteDocument(const toml::table& Root)
+        {
+            uint32 Magic = BinaryMagic;
+            uint32 Version = BinaryVersion;
+            Ar << Magic << Version;
+
+            CollectKeys(Root);
+            int32 NumKeys = Keys.Num();
+            Ar << NumKeys;
+            for (std::string_view Key : Keys)
+            {
+                WriteString(Key);
+            }
+
+            WriteTable(Root);
+        }
+
+    private:
+        void CollectKeys(const toml::node& Node)
+        {
+            if (const toml::table* Table = Node.as_table())
+            {
+                for (auto&& [Key, Value] : *Table)
+                {
+                    if (KeyIndices.try_emplace(Key.str(), Keys.Num()).second)
+                    {
+                        Keys.Add(Key.str());
+                    }
+                    CollectKeys(Value);
+                }
+            }
+            else if (const toml::array* Array = Node.as_array())
+            {
+                for (const toml::node& Element : *Array)
+                {
+                    CollectKeys(Element);
+                }
+            }
+        }
+
+        void WriteNode(const toml::node& Node)
+        {
+            uint8 Type = static_cast<uint8>(Node.type());
+            Ar << Type;
+            WritePayload(Node);
+        }
+
+        void WritePayload(const toml::node& Node)
+        {
+            switch (Node.type())
+            {
+            case toml::node_type::table:
+                WriteTable(*Node.as_table());
+                break;
+            case toml::node_type::array:
+                WriteArray(*Node.as_array());
+                break;
+            case toml::node_type::string:
+                WriteString(Node.as_string()->get());
+                break;
+            case toml::node_type::integer:
+            {
+                int64 Value = Node.as_integer()->get();
+                Ar << Value;
+                break;
+            }
+            case toml::node_type::floating_point:
+            {
+                double Value = Node.as_floating_point()->get();
+                Ar << Value;
+                break;
+            }
+            case toml::node_type::boolean:
+            {
+                uint8 Value = Node.as_boolean()->get() ? 1 : 0;
+                Ar << Value;
+                break;
+            }
+            case toml::node_type::date:
+                WriteDate(Node.as_date()->get());
+                break;
+            case toml::node_type::time:
+                WriteTime(Node.as_time()->get());
+                break;
+            case toml::node_type::date_time:
+            {
+                const toml::date_time& DateTime = Node.as_date_time()->get();
+                WriteDate(DateTime.date);
+                WriteTime(DateTime.time);
+                uint8 bHasOffset = DateTime.offset.has_value() ? 1 : 0;
+                int16 OffsetMinutes = bHasOffset ? DateTime.offset->minutes : 0;
+                Ar << bHasOffset << OffsetMinutes;
+                break;
+            }
+            default:
+                checkNoEntry();
+            }
+        }
+
+        void WriteTable(const toml::table& Table)
+        {
+            int32 NumEntries = static_cast<int32>(Table.size());
+            Ar << NumEntries;
+            for (auto&& [Key, Value] : Table)
+            {
+                int32 KeyIndex = KeyIndices.find(Key.str())->second;
+                Ar << KeyIndex;
+                WriteNode(Value);
+            }
+        }
+
+        void WriteArray(const toml::array& Array)
+        {
+            int32 NumElements = static_cast<int32>(Array.size());
+            const toml::node_type ElementType = !Array.empty() && Array.is_homogeneous(toml::node_type::none)
+                ? Array.front().type()
+                : toml::node_type::none;
+            uint8 ElementTypeValue = static_cast<uint8>(ElementType);
+            Ar << NumElements << ElementTypeValue;
+
+            switch (ElementType)
+            {
+            case toml::node_type::integer:
+                WritePacked<int64>(Array);
+                break;
+            case toml::node_type::floating_point:
+                WritePacked<double>(Array);
+                break;
+            case toml::node_type::boolean:
+                WritePacked<bool>(Array);
+                break;
+            case toml::node_type::none:
+                for (const toml::node& Element : Array)
+                {
+                    WriteNode(Element);
+                }
+                break;
+            default:
+                for (const toml::node& Element : Array)
+                {
+                    WritePayload(Element);
+                }
+                break;
+            }
+        }
+
+        template<typename NativeType>
+        void WritePacked(const toml::array& Array)
+        {
+            using PackedType = std::conditional_t<std::is_same_v<NativeType, bool>, uint8, NativeType>;
+            TArray<PackedType> Values;
+            Values.Reserve(static_cast<int32>(Array.size()));
+            for (const toml::node& Element : Array)
+            {
+                Values.Add(static_cast<PackedType>(Element.as<NativeType>()->get()));
+            }
+            SerializePacked(Ar, Values);
+        }
+
+        void WriteString(std::string_view String)
+        {
+            int32 NumBytes = static_cast<int32>(String.size());
+            Ar << NumBytes;
+            Ar.Serialize(const_cast<char*>(String.data()), NumBytes);
+        }
+
+        void WriteDate(const toml::date& Date)
+        {
+            uint16 Year = Date.year;
+            uint8 Month = Date.month;
+            uint8 Day = Date.day;
+            Ar << Year << Month << Day;
+        }
+
+        void WriteTime(const toml::time& Time)
+        {
+            uint8 Hour = Time.hour;
+            uint8 Minute = Time.minute;
+            uint8 Second = Time.second;
+            uint32 Nanosecond = Time.nanosecond;
+            Ar << Hour << Minute << Second << Nanosecond;
+        }
+
+        FArchive& Ar;
+        TArray<std::string_view> Keys;
+        std::unordered_map<std::string_view, int32> KeyIndices;
+    };
+
+    class FBinaryReader
+    {
+    public:
+        explicit FBinaryReader(FArchive& InAr)
+            : Ar(InAr)
+        {
+        }
+
+        bool ReadDocument(toml::table& OutRoot)
+        {
+            uint32 Magic = 0;
+            uint32 Version = 0;
+            Ar << Magic << Version;
+            if (Magic != BinaryMagic || Version != BinaryVersion)
+            {
+                return false;
+            }
+
+            int32 NumKeys = 0;
+            Ar << NumKeys;
+            if (!IsValidCount(NumKeys))
+            {
+                return false;
+            }
+            Keys.SetNum(NumKeys);
+            for (std::string& Key : Keys)
+            {
+                if (!ReadString(Key))
+                {
+                    return false;
+                }
+            }
+
+            return ReadTable(OutRoot, 0) && !Ar.IsError();
+        }
+
+    private:
+        // Every element takes at least one byte, which bounds counts read from corrupt data
+        bool IsValidCount(int32 Count)
+        {
+            const int64 TotalSize = Ar.TotalSize();
+            return !Ar.IsError() && Count >= 0 && (TotalSize < 0 || Count <= TotalSize - Ar.Tell());
+        }
+
+        template<typename InserterType>
+        bool ReadPayload(uint8 Type, int32 Depth, InserterType&& Insert)
+        {
+            switch (static_cast<toml::node_type>(Type))
+            {
+            case toml::node_type::table:
+            {
+                toml::table Table;
+                if (Depth >= TOML_MAX_NESTED_VALUES || !ReadTable(Table, Depth + 1))
+                {
+                    return false;
+                }
+                Insert(std::move(Table));
+                return true;
+            }
+            case toml::node_type::array:
+            {
+                toml::array Array;
+                if (Depth >= TOML_MAX_NESTED_VALUES || !ReadArray(Array, Depth + 1))
+                {
+                    return false;
+                }
+                Insert(std::move(Array));
+                return true;
+            }
+            case toml::node_type::string:
+            {
+                std::string String;
+                if (!ReadString(String))
+                {
+                    return false;
+                }
+                Insert(std::move(String));
+                return true;
+            }
+            case toml::node_type::integer:
+            {
+                int64 Value = 0;
+                Ar << Value;
+                Insert(Value);
+                return true;
+            }
+            case toml::node_type::floating_point:
+            {
+                double Value = 0.0;
+                Ar << Value;
+                Insert(Value);
+                return true;
+            }
+            case toml::node_type::boolean:
+            {
+                uint8 Value = 0;
+                Ar << Value;
+                Insert(Value != 0);
+                return true;
+            }
+            case toml::node_type::date:
+                Insert(ReadDate());
+                return true;
+            case toml::node_type::time:
+                Insert(ReadTime());
+                return true;
+            case toml::node_type::date_time:
+            {
+                toml::date_time DateTime{ ReadDate(), ReadTime() };
+                uint8 bHasOffset = 0;
+                int16 OffsetMinutes = 0;
+                Ar << bHasOffset << OffsetMinutes;
+                if (bHasOffset)
+                {
+                    DateTime.offset = toml::time_offset{};
+                    DateTime.offset->minutes = OffsetMinutes;
+                }
+                Insert(DateTime);
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+
+        bool ReadTable(toml::table& OutTable, int32 Depth)
+        {
+            int32 NumEntries = 0;
+            Ar << NumEntries;
+            if (!IsValidCount(NumEntries))
+            {
+                return false;
+            }
+
+            for (int32 Index = 0; Index < NumEntries; ++Index)
+            {
+                int32 KeyIndex = INDEX_NONE;
+                uint8 Type = 0;
+                Ar << KeyIndex << Type;
+                if (!Keys.IsValidIndex(KeyIndex))
+                {
+                    return false;
+                }
+
+                const std::string& Key = Keys[KeyIndex];
+                const bool bRead = ReadPayload(Type, Depth, [&OutTable, &Key](auto&& Value)
+                {
+                    OutTable.insert_or_assign(Key, std::forward<decltype(Value)>(Value));
+                });
+                if (!bRead || Ar.IsError())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool ReadArray(toml::array& OutArray, int32 Depth)
+        {
+            int32 NumElements = 0;
+            uint8 ElementType = 0;
+            Ar << NumElements << ElementType;
+            if (!IsValidCount(NumElements))
+            {
+                return false;
+            }
+
+            OutArray.reserve(NumElements);
+            switch (static_cast<toml::node_type>(ElementType))
+            {
+            case toml::node_type::integer:
+                return ReadPacked<int64>(OutArray, NumElements);
+            case toml::node_type::floating_point:
+                return ReadPacked<double>(OutArray, NumElements);
+            case toml::node_type::boolean:
+                return ReadPacked<bool>(OutArray, NumElements);
+            default:
+                break;
+            }
+
+            auto PushBack = [&OutArray](auto&& Value)
+            {
+                OutArray.push_back(std::forward<decltype(Value)>(Value));
+            };
+            for (int32 Index = 0; Index < NumElements; ++Index)
+            {
+                uint8 Type = ElementType;
+                if (Type == static_cast<uint8>(toml::node_type::none))
+                {
+                    Ar << Type;
+                }
+                if (!ReadPayload(Type, Depth, PushBack) || Ar.IsError())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename NativeType>
+        bool ReadPacked(toml::array& OutArray, int32 NumElements)
+        {
+            using PackedType = std::conditional_t<std::is_same_v<NativeType, bool>, uint8, NativeType>;
+            TArray<PackedType> Values;
+            Values.SetNumUninitialized(NumElements);
+            SerializePacked(Ar, Values);
+            if (Ar.IsError())
+            {
+                return false;
+            }
+
+            for (const PackedType Value : Values)
+            {
+                if constexpr (std::is_same_v<NativeType, bool>)
+                {
+                    OutArray.push_back(Value != 0);
+                }
+                else
+                {
+                    OutArray.push_back(Value);
+                }
+            }
+            return true;
+        }
+
+        bool ReadString(std::string& OutString)
+        {
+            int32 NumBytes = 0;
+            Ar << NumBytes;
+            if (!IsValidCount(NumBytes))
+            {
+                return false;
+            }
+            OutString.resize(NumBytes);
+            Ar.Serialize(OutString.data(), NumBytes);
+            return !Ar.IsError();
+        }
+
+        toml::date ReadDate()
+        {
+            uint16 Year = 0;
+            uint8 Month = 0;
+            uint8 Day = 0;
+            Ar << Year << Month << Day;
+            return toml::date{ Year, Month, Day };
+        }
+
+        toml::time ReadTime()
+        {
+            uint8 Hour = 0;
+            uint8 Minute = 0;
+            uint8 Second = 0;
+            uint32 Nanosecond = 0;
+            Ar << Hour << Minute << Second << Nanosecond;
+            return toml::time{ Hour, Minute, Second, Nanosecond };
+        }
+
+        FArchive& Ar;
+        TArray<std::string> Keys;
+    };
+
+    void WriteBinary(FArchive& Ar, const toml::table& Table)
+    {
+        FBinaryWriter(Ar).WriteDocument(Table);
+    }
+
+    bool ReadBinary(FArchive& Ar, toml::table& OutTable)
+    {
+        LLM_SCOPE_BYTAG(Toml);
+        return FBinaryReader(Ar).ReadDocument(OutTable);
+    }
+}
+
+void FTomlTable::Serialize(FArchive& Ar)
+{
+    bool bValid = IsValid();
+    Ar << bValid;
+
+    if (Ar.IsSaving())
+    {
+        if (bValid)
+        {
+            Toml::WriteBinary(Ar, Toml::AsTable(Node));
+        }
+        return;
+    }
+
+    *this = FTomlTable();
+    if (bValid)
+    {
+        toml::table Table;
+        if (Toml::ReadBinary(Ar, Table))
+        {
+            *this = FTomlTable(Toml::MakeDocument(std::move(Table)));
+        }
+        else
+        {
+            UE_LOG(LogToml, Error, TEXT("Failed to load binary TOML table from '%s'"), *Ar.GetArchiveName());
+            Ar.SetError();
+        }
+    }
+}
+
+FTomlTable FTomlTable::LoadBinary(FArchive& Ar)
+{
+    checkf(Ar.IsLoading(), TEXT("LoadBinary requires a loading archive"));
+
+    FTomlTable Result;
+    Result.Serialize(Ar);
+    return Result;
+}
@@ -0,0 +1,146 @@
+#include "UnrealToml.h"
+#include "TomlFlatTable.h"
+#include "TomlPrivate.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Cooked file layout, written next to the source file:
+//
+//   CookedFile := uint32 Magic, uint32 Version, int64 SourceSize, uint64 SourceHash, binary document (see TomlBinary.cpp)
+//
+// SourceSize and SourceHash describe the exact source bytes the document was parsed from, SourceHash being
+// their xxHash64. Loads of a source that exists only use the cooked file if the bytes they read match both,
+// so any edit to the source is parsed. Packaged builds that only stage the cooked file use it as it is.
+namespace Toml
+{
+    static constexpr uint32 CookedMagic = 0x434D4F54; // 'TOMC'
+    static constexpr uint32 CookedVersion = 3;
+
+    // Opens the cooked form of FilePath at its binary document
+    static TUniquePtr<FArchive> OpenCookedTomlFile(const FString& FilePath, int64& OutSourceSize, uint64& OutSourceHash)
+    {
+        const FString CookedFilePath = FTomlTable::GetCookedFilePath(FilePath);
+        TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*CookedFilePath, FILEREAD_Silent));
+        if (!Reader)
+        {
+            return nullptr;
+        }
+
+        uint32 Magic = 0;
+        uint32 Version = 0;
+        *Reader << Magic << Version << OutSourceSize << OutSourceHash;
+        if (Reader->IsError() || Magic != CookedMagic || Version != CookedVersion)
+        {
+            UE_LOG(LogToml, Verbose, TEXT("Ignoring out of date cooked TOML file: %s"), *CookedFilePath);
+            return nullptr;
+        }
+        return Reader;
+    }
+
+    static bool ReadCookedTable(FArchive& Reader, const FString& FilePath, toml::table& OutTable)
+    {
+        if (!ReadBinary(Reader, OutTable))
+        {
+            UE_LOG(LogToml, Warning, TEXT("Ignoring corrupt cooked TOML file: %s"), *FTomlTable::GetCookedFilePath(FilePath));
+            OutTable = toml::table();
+            return false;
+        }
+        return true;
+    }
+
+    bool ReadCookedTomlFile(const FString& FilePath, std::string_view Content, uint64 ContentHash, toml::table& OutTable)
+    {
+        int64 SourceSize = 0;
+        uint64 SourceHash = 0;
+        TUniquePtr<FArchive> Reader = OpenCookedTomlFile(FilePath, SourceSize, SourceHash);
+        if (!Reader)
+        {
+            return false;
+        }
+        if (SourceSize != static_cast<int64>(Content.size()) || SourceHash != ContentHash)
+        {
+            UE_LOG(LogToml, Verbose, TEXT("Ignoring cooked TOML file of a different source: %s"), *FTomlTable::GetCookedFilePath(FilePath));
+            return false;
+        }
+        return ReadCookedTable(*Reader, FilePath, OutTable);
+    }
+
+    bool ReadCookedTomlFile(const FString& FilePath, toml::table& OutTable)
+    {
+        int64 SourceSize = 0;
+        uint64 SourceHash = 0;
+        TUniquePtr<FArchive> Reader = OpenCookedTomlFile(FilePath, SourceSize, SourceHash);
+        return Reader && ReadCookedTable(*Reader, FilePath, OutTable);
+    }
+
+    FTomlDocumentPtr LoadCookedTomlFile(const FString& FilePath)
+    {
+        int64 SourceSize = 0;
+        uint64 SourceHash = 0;
+        TUniquePtr<FArchive> Reader = OpenCookedTomlFile(FilePath, SourceSize, SourceHash);
+        if (!Reader)
+        {
+            return nullptr;
+        }
+
+        // Shares the document with loads of the source it was cooked from
+        FString Error;
+        return FindOrParseDocument(SourceHash, static_cast<uint64>(SourceSize), [&Reader, &FilePath](toml::table& OutTable, FString& OutParseError)
+        {
+            return ReadCookedTable(*Reader, FilePath, OutTable);
+        }, Error);
+    }
+}
+
+bool FTomlTable::CookFile(const FString& FilePath)
+{
+    TArray<uint8> FileContent;
+    if (!FFileHelper::LoadFileToArray(FileContent, *FilePath))
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to read TOML file: %s"), *FilePath);
+        return false;
+    }
+
+    toml::table Table;
+    FString Error;
+    if (!Toml::ParseTomlTable(Toml::ToUtf8View(FileContent), Table, Error))
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to parse TOML file '%s': %s"), *FilePath, *Error);
+        return false;
+    }
+
+    TArray<uint8> CookedContent;
+    FMemoryWriter Writer(CookedContent);
+    uint32 Magic = Toml::CookedMagic;
+    uint32 Version = Toml::CookedVersion;
+    // Describes the bytes that were parsed, whatever happens to the file meanwhile
+    int64 SourceSize = FileContent.Num();
+    uint64 SourceHash = Toml::HashContent(Toml::ToUtf8View(FileContent));
+    Writer << Magic << Version << SourceSize << SourceHash;
+    Toml::WriteBinary(Writer, Table);
+
+    const FString CookedFilePath = GetCookedFilePath(FilePath);
+    if (!FFileHelper::SaveArrayToFile(CookedContent, *CookedFilePath))
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to write cooked TOML file: %s"), *CookedFilePath);
+        return false;
+    }
+
+    // The flat form for FTomlFlatTable::LoadFileMapped, which maps it without parsing
+    const FString FlatFilePath = FTomlFlatTable::GetCookedFilePath(FilePath);
+    if (!FFileHelper::SaveArrayToFile(Toml::Flat::Flatten(Table, FString::Printf(TEXT("file '%s'"), *FilePath)), *FlatFilePath))
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to write flat TOML file: %s"), *FlatFilePath);
+        return false;
+    }
+    return true;
+}
+
+FString FTomlTable::GetCookedFilePath(const FString& FilePath)
+{
+    return FPaths::ChangeExtension(FilePath, TEXT("tomlc"));
+}
@@ -0,0 +1,76 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Stats/Stats.h"
+
+// Change this guid to invalidate every cached TOML table, e.g. when the binary layout changes
+#define TOML_DERIVEDDATA_VER TEXT("3F0C5A1E8B7D4E2A9C6B1D0E4F7A2B58")
+
+DECLARE_STATS_GROUP(TEXT("Toml"), STATGROUP_Toml, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("DDC Hits"), STAT_TomlDDCHits, STATGROUP_Toml);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("DDC Misses"), STAT_TomlDDCMisses, STATGROUP_Toml);
+
+// A cache hit still costs a lookup and a copy of the entry, which only beats parsing for larger files.
+// UnrealToml.Benchmark.DerivedData compares the two.
+static TAutoConsoleVariable<int32> CVarTomlDerivedDataMinSizeKB(
+    TEXT("toml.DerivedData.MinSizeKB"),
+    32,
+    TEXT("Smallest TOML file in KB that is read through the derived data cache, smaller files are always parsed"));
+#endif
+
+namespace Toml
+{
+#if WITH_EDITOR
+    // Keyed by the document bytes and the toml++ version, since the parser decides what a document contains
+    FString BuildDerivedDataKey(std::string_view Content, uint64 ContentHash)
+    {
+        const FString Version = FString::Printf(TEXT("%s_%d.%d"), TOML_DERIVEDDATA_VER, TOML_LIB_MAJOR, TOML_LIB_MINOR);
+        const FString Suffix = FString::Printf(TEXT("%016llx_%llu"), ContentHash, static_cast<uint64>(Content.size()));
+        return FDerivedDataCacheInterface::BuildCacheKey(TEXT("TOML"), *Version, *Suffix);
+    }
+#endif
+
+    bool ParseTomlFile(std::string_view Content, uint64 ContentHash, toml::table& OutTable, FString& OutError)
+    {
+#if WITH_EDITOR
+        const uint64 MinSize = static_cast<uint64>(FMath::Max(CVarTomlDerivedDataMinSizeKB.GetValueOnAnyThread(), 0)) * 1024;
+        FDerivedDataCacheInterface* DerivedDataCache = Content.size() >= MinSize ? GetDerivedDataCache() : nullptr;
+        if (!DerivedDataCache)
+        {
+            return ParseTomlTable(Content, OutTable, OutError);
+        }
+
+        const FString Key = BuildDerivedDataKey(Content, ContentHash);
+        TArray<uint8> DerivedData;
+        if (DerivedDataCache->GetSynchronous(*Key, DerivedData, TEXTVIEW("TOML")))
+        {
+            FMemoryReader Reader(DerivedData);
+            if (ReadBinary(Reader, OutTable))
+            {
+                INC_DWORD_STAT(STAT_TomlDDCHits);
+                return true;
+            }
+            UE_LOG(LogToml, Warning, TEXT("Ignoring corrupt derived data for TOML table: %s"), *Key);
+        }
+
+        INC_DWORD_STAT(STAT_TomlDDCMisses);
+        if (!ParseTomlTable(Content, OutTable, OutError))
+        {
+            return false;
+        }
+
+        DerivedData.Reset();
+        FMemoryWriter Writer(DerivedData);
+        WriteBinary(Writer, OutTable);
+        DerivedDataCache->Put(*Key, DerivedData, TEXTVIEW("TOML"));
+        return true;
+#else
+        return ParseTomlTable(Content, OutTable, OutError);
+#endif
+    }
+}
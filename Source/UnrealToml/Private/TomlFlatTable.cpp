@@ -0,0 +1,730 @@
+#include "TomlFlatTable.h"
+#include "TomlPrivate.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Templates/AlignmentTemplates.h"
+
+#include <unordered_map>
+
+// Flat layout, native byte order, all offsets are from the start of the buffer:
+//
+//   Header := uint32 Magic, uint32 Version, uint32 RootOffset, uint32 Size
+//   Node   := uint8 node_type, uint8 ElementType, uint16 Reserved, uint32 Count, Payload
+//   Value  := uint8 node_type, uint8[3] Reserved, uint32 Count, uint64 Data
+//
+// Tables and arrays are nodes, starting on 8 byte boundaries. Their payloads:
+//   table          Count entries of (uint32 KeyOffset, uint32 KeyLength, Value), sorted by key bytes. Key
+//                  bytes are shared by every table using the same key.
+//   array          ElementType is the element type of homogeneous arrays and none otherwise. Integer and
+//                  float arrays store Count packed 8 byte values, boolean arrays Count bytes, all others
+//                  Count values.
+//
+// Values are 16 byte tagged unions stored inline in their table or array, so reading a scalar never
+// leaves the entry it was found in. Data by type:
+//   integer/float  the 8 byte value
+//   boolean        0 or 1
+//   string         offset of Count UTF-8 bytes followed by a null terminator
+//   table/array    offset of the node, Count is its number of entries or elements
+//   date/time      unused, they are not readable through FTomlFlatTable
+namespace Toml::Flat
+{
+    static constexpr uint32 NodeAlignment = 8;
+
+    struct FHeader
+    {
+        uint32 Magic;
+        uint32 Version;
+        uint32 RootOffset;
+        uint32 Size;
+    };
+
+    struct FNode
+    {
+        toml::node_type Type;
+        toml::node_type ElementType;
+        uint16 Reserved;
+        uint32 Count;
+    };
+    static_assert(sizeof(FNode) == 8);
+
+    struct FValue
+    {
+        toml::node_type Type = toml::node_type::none;
+        uint8 Reserved[3] = {};
+        uint32 Count = 0;
+        uint64 Data = 0;
+
+        bool IsValid() const { return Type != toml::node_type::none; }
+    };
+    static_assert(sizeof(FValue) == 16);
+
+    struct FEntry
+    {
+        uint32 KeyOffset;
+        uint32 KeyLength;
+        FValue Value;
+    };
+    static_assert(sizeof(FEntry) == 24);
+
+    template<typename T>
+    FValue MakeValue(toml::node_type Type, T Data, uint32 Count = 0)
+    {
+        FValue Value;
+        Value.Type = Type;
+        Value.Count = Count;
+        static_assert(sizeof(T) <= sizeof(Value.Data));
+        FMemory::Memcpy(&Value.Data, &Data, sizeof(T));
+        return Value;
+    }
+
+    class FWriter
+    {
+    public:
+        explicit FWriter(TArray<uint8>& InBuffer)
+            : Buffer(InBuffer)
+        {
+        }
+
+        void WriteDocument(const toml::table& Root)
+        {
+            Buffer.Reset();
+            const uint32 HeaderOffset = Allocate(sizeof(FHeader));
+            const uint32 RootOffset = WriteTable(Root);
+            Store(HeaderOffset, FHeader{ Magic, Version, RootOffset, static_cast<uint32>(Buffer.Num()) });
+        }
+
+    private:
+        uint32 Allocate(int32 NumBytes, uint32 Alignment = NodeAlignment)
+        {
+            Buffer.AddZeroed(Align(Buffer.Num(), Alignment) - Buffer.Num());
+            const uint32 Offset = Buffer.Num();
+            Buffer.AddZeroed(NumBytes);
+            return Offset;
+        }
+
+        template<typename T>
+        void Store(uint32 Offset, const T& Value)
+        {
+            FMemory::Memcpy(Buffer.GetData() + Offset, &Value, sizeof(T));
+        }
+
+        FValue WriteValue(const toml::node& Node)
+        {
+            switch (Node.type())
+            {
+            case toml::node_type::table:
+                return MakeValue(Node.type(), WriteTable(*Node.as_table()), static_cast<uint32>(Node.as_table()->size()));
+            case toml::node_type::array:
+                return MakeValue(Node.type(), WriteArray(*Node.as_array()), static_cast<uint32>(Node.as_array()->size()));
+            case toml::node_type::string:
+            {
+                const std::string& String = Node.as_string()->get();
+                return MakeValue(Node.type(), WriteString(String), static_cast<uint32>(String.size()));
+            }
+            case toml::node_type::integer:
+                return MakeValue(Node.type(), Node.as_integer()->get());
+            case toml::node_type::floating_point:
+                return MakeValue(Node.type(), Node.as_floating_point()->get());
+            case toml::node_type::boolean:
+                return MakeValue(Node.type(), Node.as_boolean()->get() ? 1ull : 0ull);
+            default:
+                return MakeValue(Node.type(), 0ull);
+            }
+        }
+
+        uint32 WriteString(std::string_view String)
+        {
+            const uint32 Offset = Allocate(String.size() + 1, 1);
+            FMemory::Memcpy(Buffer.GetData() + Offset, String.data(), String.size());
+            return Offset;
+        }
+
+        uint32 WriteKey(std::string_view Key)
+        {
+            if (const auto Found = KeyOffsets.find(std::string(Key)); Found != KeyOffsets.end())
+            {
+                return Found->second;
+            }
+            const uint32 Offset = WriteString(Key);
+            KeyOffsets.emplace(std::string(Key), Offset);
+            return Offset;
+        }
+
+        // toml::table iterates in key byte order, which is the order lookups binary search in
+        uint32 WriteTable(const toml::table& Table)
+        {
+            const uint32 NumEntries = static_cast<uint32>(Table.size());
+            const uint32 Offset = Allocate(sizeof(FNode) + NumEntries * sizeof(FEntry));
+            Store(Offset, FNode{ toml::node_type::table, toml::node_type::none, 0, NumEntries });
+
+            uint32 EntryOffset = Offset + sizeof(FNode);
+            for (auto&& [Key, Value] : Table)
+            {
+                const uint32 KeyOffset = WriteKey(Key.str());
+                const FValue EntryValue = WriteValue(Value);
+                Store(EntryOffset, FEntry{ KeyOffset, static_cast<uint32>(Key.str().size()), EntryValue });
+                EntryOffset += sizeof(FEntry);
+            }
+            return Offset;
+        }
+
+        uint32 WriteArray(const toml::array& Array)
+        {
+            const uint32 NumElements = static_cast<uint32>(Array.size());
+            const toml::node_type ElementType = !Array.empty() && Array.is_homogeneous(toml::node_type::none)
+                ? Array.front().type()
+                : toml::node_type::none;
+
+            switch (ElementType)
+            {
+            case toml::node_type::integer:
+                return WritePacked<int64>(Array, ElementType);
+            case toml::node_type::floating_point:
+                return WritePacked<double>(Array, ElementType);
+            case toml::node_type::boolean:
+                return WritePacked<bool>(Array, ElementType);
+            default:
+                break;
+            }
+
+            const uint32 Offset = Allocate(sizeof(FNode) + NumElements * sizeof(FValue));
+            Store(Offset, FNode{ toml::node_type::array, ElementType, 0, NumElements });
+
+            uint32 ElementOffset = Offset + sizeof(FNode);
+            for (const toml::node& Element : Array)
+            {
+                const FValue ElementValue = WriteValue(Element);
+                Store(ElementOffset, ElementValue);
+                ElementOffset += sizeof(FValue);
+            }
+            return Offset;
+        }
+
+        template<typename NativeType>
+        uint32 WritePacked(const toml::array& Array, toml::node_type ElementType)
+        {
+            using PackedType = std::conditional_t<std::is_same_v<NativeType, bool>, uint8, NativeType>;
+            const uint32 NumElements = static_cast<uint32>(Array.size());
+            const uint32 Offset = Allocate(sizeof(FNode) + NumElements * sizeof(PackedType));
+            Store(Offset, FNode{ toml::node_type::array, ElementType, 0, NumElements });
+
+            uint32 ElementOffset = Offset + sizeof(FNode);
+            for (const toml::node& Element : Array)
+            {
+                Store(ElementOffset, static_cast<PackedType>(Element.as<NativeType>()->get()));
+                ElementOffset += sizeof(PackedType);
+            }
+            return Offset;
+        }
+
+        TArray<uint8>& Buffer;
+        std::unordered_map<std::string, uint32> KeyOffsets;
+    };
+
+    // Flattens a table parsed only for this purpose, so it bypasses the parse cache which would keep the tree alive
+    TArray<uint8> Flatten(const toml::table& Table, const FString& SourceName)
+    {
+        LLM_SCOPE_BYTAG(Toml);
+        TArray<uint8> Buffer;
+        FWriter(Buffer).WriteDocument(Table);
+        Buffer.Shrink();
+        UE_LOG(LogToml, Verbose, TEXT("Flattened TOML %s into %d bytes, the parsed tree used about %llu bytes"),
+            *SourceName, Buffer.Num(), static_cast<uint64>(GetAllocatedSize(Table).GetTotal()));
+        return Buffer;
+    }
+
+    // Every read is bounds checked, so corrupt buffers fail lookups instead of reading out of range
+
+    bool IsInBounds(TArrayView<const uint8> Buffer, uint64 Offset, uint64 NumBytes)
+    {
+        return Offset + NumBytes <= static_cast<uint64>(Buffer.Num());
+    }
+
+    template<typename T>
+    bool Load(TArrayView<const uint8> Buffer, uint64 Offset, T& OutValue)
+    {
+        if (!IsInBounds(Buffer, Offset, sizeof(T)))
+        {
+            return false;
+        }
+        FMemory::Memcpy(&OutValue, Buffer.GetData() + Offset, sizeof(T));
+        return true;
+    }
+
+    bool LoadNode(TArrayView<const uint8> Buffer, uint64 Offset, FNode& OutNode)
+    {
+        return Offset != 0 && Offset % NodeAlignment == 0 && Load(Buffer, Offset, OutNode);
+    }
+
+    bool LoadString(TArrayView<const uint8> Buffer, uint64 Offset, uint32 Length, std::string_view& OutString)
+    {
+        if (!IsInBounds(Buffer, Offset, Length + 1ull) || Buffer[Offset + Length] != 0)
+        {
+            return false;
+        }
+        OutString = std::string_view(reinterpret_cast<const char*>(Buffer.GetData()) + Offset, Length);
+        return true;
+    }
+
+    // The node a table or array value refers to
+    bool LoadNode(TArrayView<const uint8> Buffer, const FValue& Value, toml::node_type Type, FNode& OutNode)
+    {
+        return Value.Type == Type && LoadNode(Buffer, Value.Data, OutNode) && OutNode.Type == Type;
+    }
+
+    // Returns the value for Key, invalid if TableOffset is not a table or has no such key
+    FValue FindValue(TArrayView<const uint8> Buffer, uint32 TableOffset, std::string_view Key)
+    {
+        FNode Table;
+        if (!LoadNode(Buffer, TableOffset, Table) || Table.Type != toml::node_type::table)
+        {
+            return {};
+        }
+
+        const uint64 EntriesOffset = TableOffset + sizeof(FNode);
+        int64 First = 0;
+        int64 Last = static_cast<int64>(Table.Count) - 1;
+        while (First <= Last)
+        {
+            const int64 Middle = First + (Last - First) / 2;
+            FEntry Entry;
+            std::string_view EntryKey;
+            if (!Load(Buffer, EntriesOffset + Middle * sizeof(FEntry), Entry) || !LoadString(Buffer, Entry.KeyOffset, Entry.KeyLength, EntryKey))
+            {
+                return {};
+            }
+
+            const int32 Comparison = EntryKey.compare(Key);
+            if (Comparison == 0)
+            {
+                return Entry.Value;
+            }
+            if (Comparison < 0)
+            {
+                First = Middle + 1;
+            }
+            else
+            {
+                Last = Middle - 1;
+            }
+        }
+        return {};
+    }
+
+    // Packed elements have no value of their own, one is made up for them
+    FValue FindElement(TArrayView<const uint8> Buffer, const FValue& ArrayValue, uint64 Index)
+    {
+        FNode Array;
+        if (!LoadNode(Buffer, ArrayValue, toml::node_type::array, Array) || Index >= Array.Count)
+        {
+            return {};
+        }
+
+        const uint64 ElementsOffset = ArrayValue.Data + sizeof(FNode);
+        FValue Element;
+        switch (Array.ElementType)
+        {
+        case toml::node_type::integer:
+        case toml::node_type::floating_point:
+        {
+            uint64 Data = 0;
+            return Load(Buffer, ElementsOffset + Index * sizeof(uint64), Data) ? MakeValue(Array.ElementType, Data) : FValue{};
+        }
+        case toml::node_type::boolean:
+        {
+            uint8 Data = 0;
+            return Load(Buffer, ElementsOffset + Index, Data) ? MakeValue(Array.ElementType, Data != 0 ? 1ull : 0ull) : FValue{};
+        }
+        default:
+            return Load(Buffer, ElementsOffset + Index * sizeof(FValue), Element) ? Element : FValue{};
+        }
+    }
+
+    FValue MakeTableValue(TArrayView<const uint8> Buffer, uint32 TableOffset)
+    {
+        FNode Table;
+        return LoadNode(Buffer, TableOffset, Table) ? MakeValue(toml::node_type::table, static_cast<uint64>(TableOffset), Table.Count) : FValue{};
+    }
+
+    FValue FindPath(TArrayView<const uint8> Buffer, uint32 TableOffset, std::string_view Path)
+    {
+        // Shares toml++'s path grammar so paths resolve exactly like FTomlTable::AtPath
+        FValue Current = MakeTableValue(Buffer, TableOffset);
+        struct FCursor
+        {
+            TArrayView<const uint8> Buffer;
+            FValue& Current;
+        } Cursor{ Buffer, Current };
+
+        const auto OnKey = [](void* Data, std::string_view Key) -> bool
+        {
+            FCursor& Cursor = *static_cast<FCursor*>(Data);
+            Cursor.Current = Cursor.Current.Type == toml::node_type::table
+                ? FindValue(Cursor.Buffer, static_cast<uint32>(Cursor.Current.Data), Key)
+                : FValue{};
+            return Cursor.Current.IsValid();
+        };
+        const auto OnIndex = [](void* Data, size_t Index) -> bool
+        {
+            FCursor& Cursor = *static_cast<FCursor*>(Data);
+            Cursor.Current = FindElement(Cursor.Buffer, Cursor.Current, Index);
+            return Cursor.Current.IsValid();
+        };
+
+        if (!toml::impl::parse_path(Path, &Cursor, OnKey, OnIndex))
+        {
+            return {};
+        }
+        return Current;
+    }
+
+    // Reads a value of the requested type, failing on type mismatches like toml::node::value_exact
+    template<typename T>
+    bool ReadValue(TArrayView<const uint8> Buffer, const FValue& Value, T& OutValue)
+    {
+        using NativeType = typename UETypeToNativeType<T>::Type;
+        if (Value.Type != toml::impl::node_type_of<NativeType>)
+        {
+            return false;
+        }
+
+        if constexpr (std::is_same_v<NativeType, bool>)
+        {
+            OutValue = Value.Data != 0;
+            return true;
+        }
+        else if constexpr (std::is_arithmetic_v<NativeType>)
+        {
+            NativeType Data;
+            FMemory::Memcpy(&Data, &Value.Data, sizeof(NativeType));
+            OutValue = static_cast<T>(Data);
+            return true;
+        }
+        else
+        {
+            std::string_view String;
+            if (!LoadString(Buffer, Value.Data, Value.Count, String))
+            {
+                return false;
+            }
+            OutValue = UTF8_TO_TCHAR(String.data());
+            return true;
+        }
+    }
+}
+
+void FTomlFlatTable::Build(const FTomlTable& Table, TArray<uint8>& OutBuffer)
+{
+    checkf(Table.IsValid(), TEXT("Invalid TOML file"));
+    LLM_SCOPE_BYTAG(Toml);
+    Toml::Flat::FWriter(OutBuffer).WriteDocument(Toml::AsTable(Table.Node));
+}
+
+FTomlFlatTable FTomlFlatTable::FromBuffer(TArrayView<const uint8> Buffer)
+{
+    Toml::Flat::FHeader Header;
+    if (!Toml::Flat::Load(Buffer, 0, Header) || Header.Magic != Toml::Flat::Magic || Header.Version != Toml::Flat::Version
+        || Header.Size > static_cast<uint32>(Buffer.Num()))
+    {
+        return FTomlFlatTable();
+    }
+
+    Toml::Flat::FNode Root;
+    if (!Toml::Flat::LoadNode(Buffer, Header.RootOffset, Root) || Root.Type != toml::node_type::table)
+    {
+        return FTomlFlatTable();
+    }
+    return FTomlFlatTable(Buffer, Header.RootOffset);
+}
+
+FTomlFlatTable FTomlFlatTable::FromBuffer(TArray<uint8>&& Buffer)
+{
+    TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> OwnedBuffer = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(Buffer));
+    FTomlFlatTable Result = FromBuffer(TArrayView<const uint8>(*OwnedBuffer));
+    if (Result.IsValid())
+    {
+        Result.OwnedBuffer = MoveTemp(OwnedBuffer);
+    }
+    return Result;
+}
+
+FTomlFlatTable FTomlFlatTable::FromTable(const FTomlTable& Table)
+{
+    TArray<uint8> Buffer;
+    Build(Table, Buffer);
+    Buffer.Shrink();
+    return FromBuffer(MoveTemp(Buffer));
+}
+
+FTomlFlatTable FTomlFlatTable::LoadFile(const FString& FilePath)
+{
+    TArray<uint8> Buffer;
+    {
+        toml::table Table;
+        FString Error;
+        if (!Toml::LoadTomlFile(FilePath, Table, Error))
+        {
+            UE_LOG(LogToml, Error, TEXT("%s"), *Error);
+            return FTomlFlatTable();
+        }
+        Buffer = Toml::Flat::Flatten(Table, FString::Printf(TEXT("file '%s'"), *FilePath));
+    }
+    return FromBuffer(MoveTemp(Buffer));
+}
+
+// Mapped in full, the region is unmapped before the file is closed
+struct FTomlMappedFile
+{
+    TUniquePtr<IMappedFileHandle> Handle;
+    TUniquePtr<IMappedFileRegion> Region;
+
+    ~FTomlMappedFile()
+    {
+        Region.Reset();
+    }
+};
+
+FTomlFlatTable FTomlFlatTable::LoadFileMapped(const FString& FilePath)
+{
+    const FString CookedFilePath = GetCookedFilePath(FilePath);
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TSharedPtr<FTomlMappedFile, ESPMode::ThreadSafe> MappedFile = MakeShared<FTomlMappedFile, ESPMode::ThreadSafe>();
+    MappedFile->Handle.Reset(PlatformFile.OpenMapped(*CookedFilePath));
+    if (!MappedFile->Handle)
+    {
+        // Not cooked, or mapping is unsupported on this platform
+        TArray<uint8> Buffer;
+        if (PlatformFile.FileExists(*CookedFilePath) && FFileHelper::LoadFileToArray(Buffer, *CookedFilePath, FILEREAD_Silent))
+        {
+            if (FTomlFlatTable Result = FromBuffer(MoveTemp(Buffer)); Result.IsValid())
+            {
+                return Result;
+            }
+            UE_LOG(LogToml, Warning, TEXT("Ignoring corrupt flat TOML file: %s"), *CookedFilePath);
+        }
+        return LoadFile(FilePath);
+    }
+
+    const int64 FileSize = MappedFile->Handle->GetFileSize();
+    if (FileSize > 0 && FileSize <= MAX_int32)
+    {
+        MappedFile->Region.Reset(MappedFile->Handle->MapRegion(0, FileSize));
+    }
+    if (MappedFile->Region)
+    {
+        FTomlFlatTable Result = FromBuffer(TArrayView<const uint8>(MappedFile->Region->GetMappedPtr(), static_cast<int32>(MappedFile->Region->GetMappedSize())));
+        if (Result.IsValid())
+        {
+            Result.MappedFile = MoveTemp(MappedFile);
+            return Result;
+        }
+    }
+    UE_LOG(LogToml, Warning, TEXT("Ignoring corrupt flat TOML file: %s"), *CookedFilePath);
+    return LoadFile(FilePath);
+}
+
+FString FTomlFlatTable::GetCookedFilePath(const FString& FilePath)
+{
+    return FPaths::ChangeExtension(FilePath, TEXT("tomlf"));
+}
+
+FTomlFlatTable FTomlFlatTable::LoadString(const FString& Content)
+{
+    TArray<uint8> Buffer;
+    {
+        FTCHARToUTF8 Utf8Content(*Content);
+        toml::table Table;
+        FString Error;
+        if (!Toml::ParseTomlTable(std::string_view(Utf8Content.Get(), Utf8Content.Length()), Table, Error))
+        {
+            UE_LOG(LogToml, Error, TEXT("Failed to parse TOML string: %s"), *Error);
+            return FTomlFlatTable();
+        }
+        Buffer = Toml::Flat::Flatten(Table, TEXT("string"));
+    }
+    return FromBuffer(MoveTemp(Buffer));
+}
+
+FTomlFlatTable::FTomlFlatTable()
+    : TableOffset(0)
+{
+}
+
+FTomlFlatTable::FTomlFlatTable(TArrayView<const uint8> InBuffer, uint32 InTableOffset)
+    : Buffer(InBuffer)
+    , TableOffset(InTableOffset)
+{
+}
+
+bool FTomlFlatTable::IsValid() const
+{
+    return TableOffset != 0;
+}
+
+bool FTomlFlatTable::IsEmpty() const
+{
+    Toml::Flat::FNode Table;
+    return IsValid() && Toml::Flat::LoadNode(Buffer, TableOffset, Table) && Table.Count == 0;
+}
+
+SIZE_T FTomlFlatTable::GetAllocatedSize() const
+{
+    return OwnedBuffer ? OwnedBuffer->GetAllocatedSize() : 0;
+}
+
+// Basic value getters - Checked variants
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlFlatTable::Get(const FString& Key) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    const Toml::Flat::FValue Value = Toml::Flat::FindValue(Buffer, TableOffset, TCHAR_TO_UTF8(*Key));
+    checkf(Value.IsValid(), TEXT("Key '%s' not found in TOML file"), *Key);
+    T Result{};
+    const bool bRead = Toml::Flat::ReadValue(Buffer, Value, Result);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *Key, Toml::GetTypeName<NativeType>());
+    return Result;
+}
+
+// Basic value getters - with defaults
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlFlatTable::Get(const FString& Key, T Default) const
+{
+    const Toml::Flat::FValue Value = Toml::Flat::FindValue(Buffer, TableOffset, TCHAR_TO_UTF8(*Key));
+    T Result{};
+    return Toml::Flat::ReadValue(Buffer, Value, Result) ? Result : Default;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+TArray<T> FTomlFlatTable::GetHomoArray(const FString& Key) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    const Toml::Flat::FValue Value = Toml::Flat::FindValue(Buffer, TableOffset, TCHAR_TO_UTF8(*Key));
+    checkf(Value.IsValid(), TEXT("Key '%s' not found in TOML file"), *Key);
+    Toml::Flat::FNode Array;
+    checkf(Toml::Flat::LoadNode(Buffer, Value, toml::node_type::array, Array), TEXT("Key '%s' is not a array"), *Key);
+    checkf(Array.Count == 0 || Array.ElementType == toml::impl::node_type_of<NativeType>, TEXT("Key '%s' is not homogeneous"), *Key);
+
+    TArray<T> Result;
+    Result.Reserve(Array.Count);
+    for (uint32 Index = 0; Index < Array.Count; ++Index)
+    {
+        T Element{};
+        const bool bRead = Toml::Flat::ReadValue(Buffer, Toml::Flat::FindElement(Buffer, Value, Index), Element);
+        checkf(bRead, TEXT("Key '%s' is not homogeneous"), *Key);
+        Result.Add(MoveTemp(Element));
+    }
+    return Result;
+}
+
+template <typename T> requires Toml::CPackedType<T>
+TArrayView<const T> FTomlFlatTable::GetHomoArrayView(const FString& Key) const
+{
+    const Toml::Flat::FValue Value = Toml::Flat::FindValue(Buffer, TableOffset, TCHAR_TO_UTF8(*Key));
+    checkf(Value.IsValid(), TEXT("Key '%s' not found in TOML file"), *Key);
+    Toml::Flat::FNode Array;
+    checkf(Toml::Flat::LoadNode(Buffer, Value, toml::node_type::array, Array), TEXT("Key '%s' is not a array"), *Key);
+    if (Array.Count == 0)
+    {
+        return {};
+    }
+    checkf(Array.ElementType == toml::impl::node_type_of<T>, TEXT("Key '%s' is not homogeneous"), *Key);
+
+    const uint64 ElementsOffset = Value.Data + sizeof(Toml::Flat::FNode);
+    checkf(Toml::Flat::IsInBounds(Buffer, ElementsOffset, Array.Count * sizeof(T)), TEXT("Key '%s' is out of bounds"), *Key);
+    const T* Elements = reinterpret_cast<const T*>(Buffer.GetData() + ElementsOffset);
+    checkf(IsAligned(Elements, alignof(T)), TEXT("Key '%s' is not aligned, the buffer must be 8 byte aligned"), *Key);
+    return TArrayView<const T>(Elements, Array.Count);
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlFlatTable::AtPath(const FString& Path) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    const Toml::Flat::FValue Value = Toml::Flat::FindPath(Buffer, TableOffset, TCHAR_TO_UTF8(*Path));
+    T Result{};
+    const bool bRead = Toml::Flat::ReadValue(Buffer, Value, Result);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *Path, Toml::GetTypeName<NativeType>());
+    return Result;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlFlatTable::AtPath(const FString& Path, T Default) const
+{
+    const Toml::Flat::FValue Value = Toml::Flat::FindPath(Buffer, TableOffset, TCHAR_TO_UTF8(*Path));
+    T Result{};
+    return Toml::Flat::ReadValue(Buffer, Value, Result) ? Result : Default;
+}
+
+bool FTomlFlatTable::HasKey(const FString& Key) const
+{
+    return Toml::Flat::FindValue(Buffer, TableOffset, TCHAR_TO_UTF8(*Key)).IsValid();
+}
+
+TArray<FString> FTomlFlatTable::GetKeys() const
+{
+    TArray<FString> Keys;
+    Toml::Flat::FNode Table;
+    if (!IsValid() || !Toml::Flat::LoadNode(Buffer, TableOffset, Table))
+    {
+        return Keys;
+    }
+
+    Keys.Reserve(Table.Count);
+    for (uint32 Index = 0; Index < Table.Count; ++Index)
+    {
+        Toml::Flat::FEntry Entry;
+        std::string_view Key;
+        if (Toml::Flat::Load(Buffer, TableOffset + sizeof(Toml::Flat::FNode) + Index * sizeof(Toml::Flat::FEntry), Entry)
+            && Toml::Flat::LoadString(Buffer, Entry.KeyOffset, Entry.KeyLength, Key))
+        {
+            Keys.Add(UTF8_TO_TCHAR(Key.data()));
+        }
+    }
+    return Keys;
+}
+
+// Table getters
+FTomlFlatTable FTomlFlatTable::GetTable(const FString& Key) const
+{
+    const Toml::Flat::FValue Value = Toml::Flat::FindValue(Buffer, TableOffset, TCHAR_TO_UTF8(*Key));
+    checkf(Value.IsValid(), TEXT("Key '%s' not found in TOML file"), *Key);
+    Toml::Flat::FNode Table;
+    checkf(Toml::Flat::LoadNode(Buffer, Value, toml::node_type::table, Table), TEXT("Key '%s' is not a table"), *Key);
+    FTomlFlatTable Result = *this;
+    Result.TableOffset = static_cast<uint32>(Value.Data);
+    return Result;
+}
+
+FTomlFlatTable FTomlFlatTable::GetTableAtPath(const FString& Path) const
+{
+    checkf(IsValid(), TEXT("Invalid TOML file"));
+    const Toml::Flat::FValue Value = Toml::Flat::FindPath(Buffer, TableOffset, TCHAR_TO_UTF8(*Path));
+    Toml::Flat::FNode Table;
+    checkf(Toml::Flat::LoadNode(Buffer, Value, toml::node_type::table, Table), TEXT("Path '%s' not found or not a table"), *Path);
+    FTomlFlatTable Result = *this;
+    Result.TableOffset = static_cast<uint32>(Value.Data);
+    return Result;
+}
+
+#define UE_TOML_FLAT_INSTANTIATE(Type) \
+    template Type FTomlFlatTable::Get<Type>(const FString& Key) const; \
+    template Type FTomlFlatTable::Get<Type>(const FString& Key, Type Default) const; \
+    template TArray<Type> FTomlFlatTable::GetHomoArray<Type>(const FString& Key) const; \
+    template Type FTomlFlatTable::AtPath<Type>(const FString& Path) const; \
+    template Type FTomlFlatTable::AtPath<Type>(const FString& Path, Type Default) const;
+
+UE_TOML_FLAT_INSTANTIATE(bool)
+UE_TOML_FLAT_INSTANTIATE(int32)
+UE_TOML_FLAT_INSTANTIATE(int64)
+UE_TOML_FLAT_INSTANTIATE(float)
+UE_TOML_FLAT_INSTANTIATE(double)
+UE_TOML_FLAT_INSTANTIATE(FString)
+
+#undef UE_TOML_FLAT_INSTANTIATE
+
+template TArrayView<const int64> FTomlFlatTable::GetHomoArrayView<int64>(const FString& Key) const;
+template TArrayView<const double> FTomlFlatTable::GetHomoArrayView<double>(const FString& Key) const;
@@ -0,0 +1,131 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+namespace Toml
+{
+    // Strings up to this length live inside the std::string object with the common standard libraries
+    static constexpr SIZE_T InlineStringCapacity = 15;
+
+    SIZE_T GetStringHeapSize(SIZE_T Length)
+    {
+        return Length > InlineStringCapacity ? Length + 1 : 0;
+    }
+
+    // Walks a parsed tree, estimating what toml++ allocated for it
+    class FMemoryCounter
+    {
+    public:
+        explicit FMemoryCounter(FTomlMemoryStats& InStats)
+            : Stats(InStats)
+        {
+        }
+
+        // Source regions are counted on their own, so node and key sizes leave them out
+        void AddNode(const toml::node& Node)
+        {
+            AddSourceRegion(Node.source());
+            switch (Node.type())
+            {
+            case toml::node_type::table:
+                Stats.NodeBytes += sizeof(toml::table) - sizeof(toml::source_region);
+                for (auto&& [Key, Value] : *Node.as_table())
+                {
+                    // One red-black tree node per entry, holding the key and the pointer owning the value
+                    Stats.ContainerBytes += 4 * sizeof(void*);
+                    Stats.KeyBytes += sizeof(toml::key) - sizeof(toml::source_region) + GetStringHeapSize(Key.str().size());
+                    AddSourceRegion(Key.source());
+                    AddNode(Value);
+                }
+                break;
+            case toml::node_type::array:
+                Stats.NodeBytes += sizeof(toml::array) - sizeof(toml::source_region);
+                Stats.ContainerBytes += Node.as_array()->capacity() * sizeof(void*);
+                for (const toml::node& Element : *Node.as_array())
+                {
+                    AddNode(Element);
+                }
+                break;
+            case toml::node_type::string:
+                Stats.NodeBytes += sizeof(toml::value<std::string>) - sizeof(toml::source_region);
+                Stats.StringBytes += GetStringHeapSize(Node.as_string()->get().capacity());
+                break;
+            case toml::node_type::integer:
+                Stats.NodeBytes += sizeof(toml::value<int64>) - sizeof(toml::source_region);
+                break;
+            case toml::node_type::floating_point:
+                Stats.NodeBytes += sizeof(toml::value<double>) - sizeof(toml::source_region);
+                break;
+            case toml::node_type::boolean:
+                Stats.NodeBytes += sizeof(toml::value<bool>) - sizeof(toml::source_region);
+                break;
+            default:
+                Stats.NodeBytes += sizeof(toml::value<toml::date_time>) - sizeof(toml::source_region);
+                break;
+            }
+        }
+
+    private:
+        void AddSourceRegion(const toml::source_region& Source)
+        {
+            Stats.SourceRegionBytes += sizeof(toml::source_region);
+            // Every node and key parsed from one source shares its path string
+            if (Source.path && !SourcePaths.Contains(Source.path.get()))
+            {
+                SourcePaths.Add(Source.path.get());
+                // The string and the reference counts allocated alongside it by std::make_shared
+                Stats.SourcePathBytes += sizeof(std::string) + 2 * sizeof(int32) + GetStringHeapSize(Source.path->capacity());
+            }
+        }
+
+        FTomlMemoryStats& Stats;
+        TSet<const std::string*> SourcePaths;
+    };
+
+    FTomlMemoryStats GetAllocatedSize(const toml::node& Node)
+    {
+        FTomlMemoryStats Stats;
+        FMemoryCounter(Stats).AddNode(Node);
+        return Stats;
+    }
+}
+
+SIZE_T FTomlTableIndex::GetAllocatedSize() const
+{
+    return Slots.GetAllocatedSize();
+}
+
+FTomlMemoryStats FTomlDocument::GetAllocatedSize() const
+{
+    FTomlMemoryStats Stats = Toml::GetAllocatedSize(Root);
+    Stats.IndexBytes += TableIndices.GetAllocatedSize();
+    for (const TPair<const toml::table*, FTomlTableIndex>& Pair : TableIndices)
+    {
+        Stats.IndexBytes += Pair.Value.GetAllocatedSize();
+    }
+
+    {
+        FReadScopeLock ReadLock(PackedArraysLock);
+        Stats.IndexBytes += PackedIntegers.GetAllocatedSize() + PackedFloats.GetAllocatedSize();
+        for (const TPair<const toml::array*, TUniquePtr<TArray<int64>>>& Pair : PackedIntegers)
+        {
+            Stats.IndexBytes += sizeof(TArray<int64>) + Pair.Value->GetAllocatedSize();
+        }
+        for (const TPair<const toml::array*, TUniquePtr<TArray<double>>>& Pair : PackedFloats)
+        {
+            Stats.IndexBytes += sizeof(TArray<double>) + Pair.Value->GetAllocatedSize();
+        }
+    }
+
+    FReadScopeLock ReadLock(NameIndicesLock);
+    Stats.IndexBytes += NameIndices.GetAllocatedSize();
+    for (const TPair<const toml::table*, TUniquePtr<FNameIndex>>& Pair : NameIndices)
+    {
+        Stats.IndexBytes += sizeof(FNameIndex) + Pair.Value->GetAllocatedSize();
+    }
+    return Stats;
+}
+
+FTomlMemoryStats FTomlTable::GetAllocatedSize() const
+{
+    return Document ? Document->GetAllocatedSize() : FTomlMemoryStats();
+}
@@ -0,0 +1,161 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+#include "Containers/List.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/IConsoleManager.h"
+#include "Hash/xxhash.h"
+#include "Misc/ScopeLock.h"
+
+static TAutoConsoleVariable<int32> CVarTomlParseCacheSizeMB(
+    TEXT("toml.ParseCache.SizeMB"),
+    16,
+    TEXT("Memory budget in MB for parsed TOML documents shared between loads of identical content, 0 disables the cache"));
+
+namespace Toml
+{
+    static SIZE_T GetParseCacheBudget()
+    {
+        return static_cast<SIZE_T>(FMath::Max(CVarTomlParseCacheSizeMB.GetValueOnAnyThread(), 0)) * 1024 * 1024;
+    }
+
+    class FParseCache
+    {
+    public:
+        static FParseCache& Get()
+        {
+            static FParseCache Instance;
+            return Instance;
+        }
+
+        FTomlDocumentPtr Find(uint64 Hash, uint64 ContentSize)
+        {
+            FScopeLock Lock(&CriticalSection);
+            FEntry* Entry = Entries.Find(Hash);
+            // The size rules out most hash collisions for free
+            if (!Entry || Entry->ContentSize != ContentSize)
+            {
+                return nullptr;
+            }
+            RecentlyUsed.RemoveNode(Entry->RecentlyUsedNode, false);
+            RecentlyUsed.AddHead(Entry->RecentlyUsedNode);
+            return Entry->Document;
+        }
+
+        void Add(uint64 Hash, uint64 ContentSize, const FTomlDocumentPtr& Document, SIZE_T Budget)
+        {
+            const SIZE_T DocumentSize = Document->GetAllocatedSize().GetTotal();
+            if (DocumentSize > Budget)
+            {
+                return;
+            }
+
+            FScopeLock Lock(&CriticalSection);
+            if (Entries.Contains(Hash))
+            {
+                // Another thread parsed the same content concurrently
+                return;
+            }
+
+            // Not in the recently used list yet, so only older documents make room for it
+            TotalSize += DocumentSize;
+            EvictToBudget(Budget);
+
+            FRecentlyUsedList::TDoubleLinkedListNode* Node = new FRecentlyUsedList::TDoubleLinkedListNode(Hash);
+            RecentlyUsed.AddHead(Node);
+            Entries.Add(Hash, { Document, ContentSize, DocumentSize, Node });
+            Documents.Add(Document.Get(), Hash);
+        }
+
+        void Charge(const FTomlDocument& Document, SIZE_T Bytes)
+        {
+            FScopeLock Lock(&CriticalSection);
+            const uint64* Hash = Documents.Find(&Document);
+            if (!Hash)
+            {
+                return;
+            }
+            Entries.FindChecked(*Hash).Size += Bytes;
+            TotalSize += Bytes;
+            EvictToBudget(GetParseCacheBudget());
+        }
+
+    private:
+        using FRecentlyUsedList = TDoubleLinkedList<uint64>;
+
+        struct FEntry
+        {
+            FTomlDocumentPtr Document;
+            uint64 ContentSize;
+            // Memory of the document, grown by Charge as it builds indices
+            SIZE_T Size;
+            FRecentlyUsedList::TDoubleLinkedListNode* RecentlyUsedNode;
+        };
+
+        // Evicts least recently used documents until the others fit in Budget
+        void EvictToBudget(SIZE_T Budget)
+        {
+            while (TotalSize > Budget && RecentlyUsed.GetTail())
+            {
+                FRecentlyUsedList::TDoubleLinkedListNode* Oldest = RecentlyUsed.GetTail();
+                const FEntry Entry = Entries.FindAndRemoveChecked(Oldest->GetValue());
+                Documents.Remove(Entry.Document.Get());
+                TotalSize -= Entry.Size;
+                RecentlyUsed.RemoveNode(Oldest);
+            }
+        }
+
+        FCriticalSection CriticalSection;
+        TMap<uint64, FEntry> Entries;
+        // Hashes of the entries, most recently used first
+        FRecentlyUsedList RecentlyUsed;
+        TMap<const FTomlDocument*, uint64> Documents;
+        SIZE_T TotalSize = 0;
+    };
+
+    uint64 HashContent(std::string_view Content)
+    {
+        return FXxHash64::HashBuffer(Content.data(), Content.size()).Hash;
+    }
+
+    static FTomlDocumentPtr FindOrParseDocumentWithBudget(uint64 ContentHash, uint64 ContentSize, SIZE_T Budget, TFunctionRef<bool(toml::table&, FString&)> Parse, FString& OutError)
+    {
+        if (Budget > 0)
+        {
+            if (FTomlDocumentPtr Document = FParseCache::Get().Find(ContentHash, ContentSize))
+            {
+                return Document;
+            }
+        }
+
+        toml::table Table;
+        if (!Parse(Table, OutError))
+        {
+            return nullptr;
+        }
+
+        FTomlDocumentPtr Document = MakeDocument(std::move(Table));
+        if (Budget > 0)
+        {
+            FParseCache::Get().Add(ContentHash, ContentSize, Document, Budget);
+        }
+        return Document;
+    }
+
+    FTomlDocumentPtr FindOrParseDocument(std::string_view Content, TFunctionRef<bool(toml::table&, FString&)> Parse, FString& OutError)
+    {
+        const SIZE_T Budget = GetParseCacheBudget();
+        const uint64 Hash = Budget > 0 ? HashContent(Content) : 0;
+        return FindOrParseDocumentWithBudget(Hash, Content.size(), Budget, Parse, OutError);
+    }
+
+    FTomlDocumentPtr FindOrParseDocument(uint64 ContentHash, uint64 ContentSize, TFunctionRef<bool(toml::table&, FString&)> Parse, FString& OutError)
+    {
+        return FindOrParseDocumentWithBudget(ContentHash, ContentSize, GetParseCacheBudget(), Parse, OutError);
+    }
+
+    void ChargeParseCache(const FTomlDocument& Document, SIZE_T Bytes)
+    {
+        FParseCache::Get().Charge(Document, Bytes);
+    }
+}
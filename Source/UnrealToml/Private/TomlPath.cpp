@@ -0,0 +1,64 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+FTomlPath::FTomlPath(const FString& InPath)
+    : Path(InPath)
+{
+    // Shares toml++'s path grammar so paths resolve exactly like the string overloads of AtPath
+    const auto OnKey = [](void* Data, std::string_view Key) -> bool
+    {
+        FTomlPath& This = *static_cast<FTomlPath*>(Data);
+        This.Segments.Add({ INDEX_NONE, This.KeyBuffer.Num(), static_cast<int32>(Key.size()), Toml::HashKey(Key) });
+        This.KeyBuffer.Append(Key.data(), static_cast<int32>(Key.size()));
+        return true;
+    };
+    const auto OnIndex = [](void* Data, size_t Index) -> bool
+    {
+        FTomlPath& This = *static_cast<FTomlPath*>(Data);
+        This.Segments.Add({ static_cast<int64>(Index), 0, 0, 0 });
+        return true;
+    };
+
+    FTCHARToUTF8 Utf8Path(*Path);
+    bValid = toml::impl::parse_path(std::string_view(Utf8Path.Get(), Utf8Path.Length()), this, OnKey, OnIndex);
+    if (!bValid)
+    {
+        Segments.Empty();
+        KeyBuffer.Empty();
+    }
+}
+
+const toml::node* FTomlPathResolver::FindNode(const FTomlTable& Table, const FTomlPath& Path)
+{
+    if (!Table.Node || !Path.bValid)
+    {
+        return nullptr;
+    }
+
+    const toml::node* Current = &Toml::AsTable(Table.Node);
+    for (const FTomlPath::FSegment& Segment : Path.Segments)
+    {
+        if (Segment.Index == INDEX_NONE)
+        {
+            const toml::table* CurrentTable = Current->as_table();
+            if (!CurrentTable)
+            {
+                return nullptr;
+            }
+            const std::string_view Key(Path.KeyBuffer.GetData() + Segment.KeyOffset, Segment.KeyLength);
+            const FTomlTableIndex* Index = Current == &Toml::AsTable(Table.Node) ? Table.Index : Table.Document->TableIndices.Find(CurrentTable);
+            Current = Index ? Index->Find(Key, Segment.KeyHash) : CurrentTable->get(Key);
+        }
+        else
+        {
+            const toml::array* CurrentArray = Current->as_array();
+            Current = CurrentArray ? CurrentArray->get(static_cast<size_t>(Segment.Index)) : nullptr;
+        }
+
+        if (!Current)
+        {
+            return nullptr;
+        }
+    }
+    return Current;
+}
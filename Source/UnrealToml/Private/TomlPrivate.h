@@ -0,0 +1,339 @@
+#pragma once
+
+#include "UnrealToml.h"
+
+#include "HAL/LowLevelMemTracker.h"
+#include "Logging/LogMacros.h"
+#include "Misc/ScopeRWLock.h"
+#include "Templates/Function.h"
+#include "Templates/SharedPointer.h"
+#include "Templates/UniquePtr.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogToml, Log, All);
+// Parsed documents, their indices and flat buffers. std containers in toml++ allocate through the global
+// operator new, which the engine routes to FMemory, so scopes at the entry points catch their allocations too.
+LLM_DECLARE_TAG(Toml);
+
+#define TOML_EXCEPTIONS 0
+#define TOML_ENABLE_WINDOWS_COMPAT 0
+#include "toml.hpp"
+
+// Open addressing hash index over the entries of a wide table. toml::table is a std::map, so lookups
+// in tables with thousands of keys otherwise pay O(log n) string compares and pointer chasing.
+class FTomlTableIndex
+{
+public:
+    explicit FTomlTableIndex(const toml::table& Table);
+
+    const toml::node* Find(std::string_view Key) const;
+    // Hash must be Toml::HashKey(Key)
+    const toml::node* Find(std::string_view Key, uint64 Hash) const;
+    SIZE_T GetAllocatedSize() const;
+
+    // Keep the index in sync with a uniquely owned document that is being mutated.
+    // Key must be the key string stored in the table, which outlives the index entry.
+    void Add(std::string_view Key, const toml::node* Node);
+    void Update(std::string_view Key, const toml::node* Node);
+    void Remove(std::string_view Key);
+
+private:
+    struct FSlot
+    {
+        uint64 Hash = 0;
+        std::string_view Key;
+        const toml::node* Node = nullptr;
+    };
+
+    int32 FindSlot(uint64 Hash, std::string_view Key) const;
+    void Insert(const FSlot& Slot);
+    void Rehash(int32 NumSlots);
+
+    // Power of two sized and at most half full, empty slots have no node
+    TArray<FSlot> Slots;
+    int32 NumEntries = 0;
+};
+
+// Parsed tree, never modified while shared so it can be shared between tables and through the parse cache.
+// FTomlTable mutators copy the document first unless they hold the only reference to it.
+// toml++ allocates every node, key and string of Root on its own and has no allocator hook, so a document costs
+// one allocation per element to build and one free per element to destroy. There is no arena behind it,
+// FTomlFlatTable is the form that holds a whole document in a single buffer.
+struct FTomlDocument
+{
+    // Tables of Toml::MinIndexedTableSize entries or more get a hash index if bInIndexTables is set
+    FTomlDocument(toml::table&& InRoot, bool bInIndexTables);
+
+    // Mutate Table, one of the tables of this document, keeping TableIndices in sync.
+    // Only valid while the document is uniquely owned. The lazily built indices are still changed under their
+    // write locks, like everywhere else.
+    template<typename NativeType>
+    void SetValue(const toml::table& Table, std::string_view Key, NativeType&& Value)
+    {
+        FWriteScopeLock NameIndicesWriteLock(NameIndicesLock);
+        FWriteScopeLock PackedArraysWriteLock(PackedArraysLock);
+        toml::table& MutableTable = const_cast<toml::table&>(Table);
+        if (const toml::node* Old = MutableTable.get(Key))
+        {
+            RemoveIndices(*Old);
+        }
+        const auto [It, bInserted] = MutableTable.insert_or_assign(Key, std::forward<NativeType>(Value));
+        OnValueSet(Table, It->first.str(), It->second, bInserted);
+        ++Generation;
+    }
+    bool RemoveValue(const toml::table& Table, std::string_view Key);
+
+    // Includes the indices built so far
+    FTomlMemoryStats GetAllocatedSize() const;
+
+    // Looks up a direct child of Table by the key spelled like Name, remembering the result per name
+    const toml::node* FindNode(const toml::table& Table, FName Name) const;
+
+    // Packed copy of Array if it is a non-empty array of only NativeType values, built on first use
+    template<Toml::CPackedType NativeType>
+    const TArray<NativeType>* FindPackedArray(const toml::array& Array) const;
+    // Packed copy of Array if one was built already, never builds one
+    template<Toml::CPackedType NativeType>
+    const TArray<NativeType>* FindExistingPackedArray(const toml::array& Array) const;
+
+    toml::table Root;
+    // False for lean documents, see ETomlLoadOptions::Lean
+    const bool bIndexTables;
+    // Indices of the tables with at least Toml::MinIndexedTableSize entries, built with the document
+    TMap<const toml::table*, FTomlTableIndex> TableIndices;
+    // Bumped by every change to the tree, value handles taken at an older generation may refer to freed nodes.
+    // Only changes while the document is uniquely owned, handles read it with the document pinned.
+    uint32 Generation = 0;
+
+private:
+    // Both run with the write locks of the lazily built indices held
+    void OnValueSet(const toml::table& Table, std::string_view Key, const toml::node& Value, bool bInserted);
+    // Indexes Node and every table and array below it
+    void BuildIndices(const toml::node& Node);
+    // Drops the indices of Node and every table below it, before Node is destroyed
+    void RemoveIndices(const toml::node& Node);
+
+    // Nodes of one table by the names looked up in it so far, a null node meaning there is no such key.
+    // Keys are only resolved from the spelling of a queried name, no key is ever made into a name.
+    struct FNameIndex
+    {
+        struct FEntry
+        {
+            // As it was queried, names ignore case while keys do not
+            FName Name;
+            const toml::node* Node;
+        };
+
+        const FEntry* Find(FName Name) const;
+        void Add(FName Name, const toml::node* Node);
+        SIZE_T GetAllocatedSize() const;
+
+        TMap<FName, FEntry> Entries;
+        // Names already taken in Entries by a name that differs only by case, which can spell another key
+        TArray<FEntry> CaseVariants;
+    };
+
+    // Filled in lazily by FindNode, possibly from several threads sharing the document
+    mutable FRWLock NameIndicesLock;
+    // Held by pointer so lookups can keep using an index while other threads add theirs
+    mutable TMap<const toml::table*, TUniquePtr<FNameIndex>> NameIndices;
+
+    template<Toml::CPackedType NativeType>
+    TMap<const toml::array*, TUniquePtr<TArray<NativeType>>>& GetPackedArrays() const
+    {
+        if constexpr (std::is_same_v<NativeType, int64>)
+        {
+            return PackedIntegers;
+        }
+        else
+        {
+            return PackedFloats;
+        }
+    }
+
+    // Contiguous copies of the integer and float arrays viewed so far. Only arrays that are viewed pay for a
+    // second copy of their elements. Built lazily by FindPackedArray, like the name indices.
+    mutable FRWLock PackedArraysLock;
+    // Held by pointer so copies and views handed out stay put while other threads add theirs
+    mutable TMap<const toml::array*, TUniquePtr<TArray<int64>>> PackedIntegers;
+    mutable TMap<const toml::array*, TUniquePtr<TArray<double>>> PackedFloats;
+};
+
+using FTomlDocumentPtr = TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe>;
+
+// Walks the segments of an FTomlPath, which are private to it
+struct FTomlPathResolver
+{
+    // Null if the path is invalid or does not lead to a node
+    static const toml::node* FindNode(const FTomlTable& Table, const FTomlPath& Path);
+};
+
+namespace Toml
+{
+    // FTomlNode is never defined, it lets the public headers refer to a toml::table without including toml++
+    inline const toml::table& AsTable(const FTomlNode* Node)
+    {
+        return *reinterpret_cast<const toml::table*>(Node);
+    }
+
+    inline const FTomlNode* AsNode(const toml::table& Table)
+    {
+        return reinterpret_cast<const FTomlNode*>(&Table);
+    }
+
+    // Value handles refer to nodes of any type the same way
+    inline const toml::node& AsValueNode(const FTomlNode* Node)
+    {
+        return *reinterpret_cast<const toml::node*>(Node);
+    }
+
+    inline const FTomlNode* AsNode(const toml::node& Value)
+    {
+        return reinterpret_cast<const FTomlNode*>(&Value);
+    }
+
+    // Looks up a direct child of the table Node
+    inline const toml::node* FindNode(const FTomlNode* Node, const FTomlTableIndex* Index, std::string_view Key)
+    {
+        return Index ? Index->Find(Key) : AsTable(Node).get(Key);
+    }
+
+    uint64 HashKey(std::string_view Key);
+
+    inline std::string_view ToStdView(FUtf8StringView View)
+    {
+        return std::string_view(reinterpret_cast<const char*>(View.GetData()), View.Len());
+    }
+
+    inline FUtf8StringView AsUtf8View(const FTCHARToUTF8& Converted)
+    {
+        return FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Converted.Get()), Converted.Length());
+    }
+
+    // Smaller tables are searched directly, where the std::map lookup is already cheap
+    static constexpr SIZE_T MinIndexedTableSize = 16;
+
+    template<typename T>
+    struct UETypeToNativeType { using Type = T; };
+    template<>
+    struct UETypeToNativeType<int32> { using Type = int64; };
+    template<>
+    struct UETypeToNativeType<float> { using Type = double; };
+    template<>
+    struct UETypeToNativeType<FString> { using Type = std::string; };
+
+    // Reads Node if it holds exactly the native type of T
+    template<typename T>
+    bool ReadValue(const toml::node* Node, T& OutValue)
+    {
+        using NativeType = typename UETypeToNativeType<T>::Type;
+        const toml::value<NativeType>* Value = Node ? Node->as<NativeType>() : nullptr;
+        if (!Value)
+        {
+            return false;
+        }
+        if constexpr (CValueType<T>)
+        {
+            OutValue = static_cast<T>(Value->get());
+        }
+        else if constexpr (CStringType<T>)
+        {
+            OutValue = UTF8_TO_TCHAR(Value->get().c_str());
+        }
+        return true;
+    }
+
+    [[noreturn]] inline void Unreachable()
+    {
+        // Uses compiler specific extensions if possible.
+        // Even if no extension is used, undefined behavior is still raised by
+        // an empty function body and the noreturn attribute.
+#if defined(_MSC_VER) && !defined(__clang__) // MSVC
+        __assume(false);
+#else // GCC, Clang
+        __builtin_unreachable();
+#endif
+    }
+    
+    template<typename T>
+    const TCHAR* GetTypeName()
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            return TEXT("bool");
+        }
+        else if constexpr (std::is_same_v<T, int64>)
+        {
+            return TEXT("integer");
+        }
+        else if constexpr (std::is_same_v<T, double>)
+        {
+            return TEXT("float-point");
+        }
+        else if (std::is_same_v<T, std::string>)
+        {
+            return TEXT("string");
+        }
+        Unreachable();
+    }
+
+    // Mutable for FTomlTable::MakeUnique, every other holder only reads it
+    inline TSharedPtr<FTomlDocument, ESPMode::ThreadSafe> MakeDocument(toml::table&& Root, bool bIndexTables = true)
+    {
+        LLM_SCOPE_BYTAG(Toml);
+        return MakeShared<FTomlDocument, ESPMode::ThreadSafe>(std::move(Root), bIndexTables);
+    }
+
+    bool ParseTomlTable(std::string_view Content, toml::table& OutTable, FString& OutError);
+    std::string_view ToUtf8View(const TArray<uint8>& Bytes);
+
+    // Binary form of a parsed tree, see TomlBinary.cpp for the layout
+    void WriteBinary(FArchive& Ar, const toml::table& Table);
+    bool ReadBinary(FArchive& Ar, toml::table& OutTable);
+
+#if WITH_EDITOR
+    FString BuildDerivedDataKey(std::string_view Content, uint64 ContentHash);
+#endif
+
+    // ParseTomlTable for file contents, going through the derived data cache in editor builds for files of at
+    // least toml.DerivedData.MinSizeKB.
+    // ContentHash must be HashContent(Content), it is part of the derived data key.
+    bool ParseTomlFile(std::string_view Content, uint64 ContentHash, toml::table& OutTable, FString& OutError);
+
+    // Estimate of the heap memory owned by a parsed node, including the source regions toml++ keeps on every node and key
+    FTomlMemoryStats GetAllocatedSize(const toml::node& Node);
+
+    // xxHash64 of document bytes, keys both the parse cache and the derived data cache
+    uint64 HashContent(std::string_view Content);
+
+    // Returns the document for Content, shared with every other load of identical bytes while it stays
+    // in the parse cache. Parse is only called on a cache miss.
+    FTomlDocumentPtr FindOrParseDocument(std::string_view Content, TFunctionRef<bool(toml::table&, FString&)> Parse, FString& OutError);
+    // Same for content known by its xxHash64 and size, such as the source described by a cooked file
+    FTomlDocumentPtr FindOrParseDocument(uint64 ContentHash, uint64 ContentSize, TFunctionRef<bool(toml::table&, FString&)> Parse, FString& OutError);
+    // Adds memory Document allocated after it was parsed, such as lazily built indices, to its size in the parse cache
+    void ChargeParseCache(const FTomlDocument& Document, SIZE_T Bytes);
+
+    // Reads the cooked form of FilePath if it was cooked from exactly Content, ContentHash being HashContent(Content)
+    bool ReadCookedTomlFile(const FString& FilePath, std::string_view Content, uint64 ContentHash, toml::table& OutTable);
+    // Reads the cooked form of FilePath as it is, for when the source is absent
+    bool ReadCookedTomlFile(const FString& FilePath, toml::table& OutTable);
+    // Same through the parse cache, null if there is no usable cooked file
+    FTomlDocumentPtr LoadCookedTomlFile(const FString& FilePath);
+
+    // Table of a TOML file, from its cooked form if that was cooked from the current source or there is no source
+    bool LoadTomlFile(const FString& FilePath, toml::table& OutTable, FString& OutError);
+    // Same through the parse cache
+    FTomlDocumentPtr LoadTomlFile(const FString& FilePath, FString& OutError);
+    // Document of the already read content of FilePath
+    FTomlDocumentPtr LoadTomlFileContent(const FString& FilePath, std::string_view Content, FString& OutError);
+}
+
+namespace Toml::Flat
+{
+    // Header of the flat layout, a buffer of another magic or version is rejected
+    inline constexpr uint32 Magic = 0x464D4F54; // 'TOMF'
+    inline constexpr uint32 Version = 2;
+
+    // Flat layout of Table, see TomlFlatTable.cpp. SourceName describes the table in the log.
+    TArray<uint8> Flatten(const toml::table& Table, const FString& SourceName);
+}
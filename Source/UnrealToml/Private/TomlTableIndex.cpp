@@ -0,0 +1,341 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+#include "Hash/xxhash.h"
+#include "Misc/StringBuilder.h"
+
+namespace Toml
+{
+    uint64 HashKey(std::string_view Key)
+    {
+        return FXxHash64::HashBuffer(Key.data(), Key.size()).Hash;
+    }
+}
+
+FTomlTableIndex::FTomlTableIndex(const toml::table& Table)
+{
+    Slots.SetNum(FMath::RoundUpToPowerOfTwo(static_cast<uint32>(Table.size()) * 2));
+    for (auto&& [Key, Value] : Table)
+    {
+        Insert({ Toml::HashKey(Key.str()), Key.str(), &Value });
+    }
+    NumEntries = static_cast<int32>(Table.size());
+}
+
+const toml::node* FTomlTableIndex::Find(std::string_view Key) const
+{
+    return Find(Key, Toml::HashKey(Key));
+}
+
+const toml::node* FTomlTableIndex::Find(std::string_view Key, uint64 Hash) const
+{
+    const int32 SlotIndex = FindSlot(Hash, Key);
+    return SlotIndex != INDEX_NONE ? Slots[SlotIndex].Node : nullptr;
+}
+
+void FTomlTableIndex::Add(std::string_view Key, const toml::node* Node)
+{
+    if ((NumEntries + 1) * 2 > Slots.Num())
+    {
+        Rehash(Slots.Num() * 2);
+    }
+    Insert({ Toml::HashKey(Key), Key, Node });
+    ++NumEntries;
+}
+
+void FTomlTableIndex::Update(std::string_view Key, const toml::node* Node)
+{
+    const int32 SlotIndex = FindSlot(Toml::HashKey(Key), Key);
+    check(SlotIndex != INDEX_NONE);
+    Slots[SlotIndex].Node = Node;
+}
+
+void FTomlTableIndex::Remove(std::string_view Key)
+{
+    int32 EmptyIndex = FindSlot(Toml::HashKey(Key), Key);
+    if (EmptyIndex == INDEX_NONE)
+    {
+        return;
+    }
+    Slots[EmptyIndex] = {};
+    --NumEntries;
+
+    // Shift back later entries of the probe sequence so lookups never stop at the new gap
+    const uint32 Mask = Slots.Num() - 1;
+    for (uint32 SlotIndex = (EmptyIndex + 1) & Mask; Slots[SlotIndex].Node; SlotIndex = (SlotIndex + 1) & Mask)
+    {
+        const uint32 HomeIndex = static_cast<uint32>(Slots[SlotIndex].Hash) & Mask;
+        const uint32 DistanceToHome = (SlotIndex - HomeIndex) & Mask;
+        const uint32 DistanceToEmpty = (SlotIndex - EmptyIndex) & Mask;
+        if (DistanceToHome >= DistanceToEmpty)
+        {
+            Slots[EmptyIndex] = Slots[SlotIndex];
+            Slots[SlotIndex] = {};
+            EmptyIndex = SlotIndex;
+        }
+    }
+}
+
+int32 FTomlTableIndex::FindSlot(uint64 Hash, std::string_view Key) const
+{
+    const uint32 Mask = Slots.Num() - 1;
+    for (uint32 SlotIndex = static_cast<uint32>(Hash) & Mask; Slots[SlotIndex].Node; SlotIndex = (SlotIndex + 1) & Mask)
+    {
+        const FSlot& Slot = Slots[SlotIndex];
+        if (Slot.Hash == Hash && Slot.Key == Key)
+        {
+            return SlotIndex;
+        }
+    }
+    return INDEX_NONE;
+}
+
+void FTomlTableIndex::Insert(const FSlot& Slot)
+{
+    const uint32 Mask = Slots.Num() - 1;
+    uint32 SlotIndex = static_cast<uint32>(Slot.Hash) & Mask;
+    while (Slots[SlotIndex].Node)
+    {
+        SlotIndex = (SlotIndex + 1) & Mask;
+    }
+    Slots[SlotIndex] = Slot;
+}
+
+void FTomlTableIndex::Rehash(int32 NumSlots)
+{
+    TArray<FSlot> OldSlots = MoveTemp(Slots);
+    Slots.SetNum(NumSlots);
+    for (const FSlot& Slot : OldSlots)
+    {
+        if (Slot.Node)
+        {
+            Insert(Slot);
+        }
+    }
+}
+
+FTomlDocument::FTomlDocument(toml::table&& InRoot, bool bInIndexTables)
+    : Root(std::move(InRoot))
+    , bIndexTables(bInIndexTables)
+{
+    LLM_SCOPE_BYTAG(Toml);
+    BuildIndices(Root);
+}
+
+bool FTomlDocument::RemoveValue(const toml::table& Table, std::string_view Key)
+{
+    FWriteScopeLock NameIndicesWriteLock(NameIndicesLock);
+    FWriteScopeLock PackedArraysWriteLock(PackedArraysLock);
+    toml::table& MutableTable = const_cast<toml::table&>(Table);
+    const auto It = MutableTable.find(Key);
+    if (It == MutableTable.end())
+    {
+        return false;
+    }
+
+    // Index entries refer to the key string, so they go before the entry itself
+    RemoveIndices(It->second);
+    NameIndices.Remove(&Table);
+    if (FTomlTableIndex* Index = TableIndices.Find(&Table))
+    {
+        Index->Remove(Key);
+    }
+    MutableTable.erase(It);
+    ++Generation;
+    return true;
+}
+
+void FTomlDocument::OnValueSet(const toml::table& Table, std::string_view Key, const toml::node& Value, bool bInserted)
+{
+    // Names are resolved again on their next lookup, including those that found no key before
+    NameIndices.Remove(&Table);
+    BuildIndices(Value);
+    if (FTomlTableIndex* Index = TableIndices.Find(&Table))
+    {
+        if (bInserted)
+        {
+            Index->Add(Key, &Value);
+        }
+        else
+        {
+            Index->Update(Key, &Value);
+        }
+    }
+    else if (bIndexTables && Table.size() >= Toml::MinIndexedTableSize)
+    {
+        TableIndices.Add(&Table, FTomlTableIndex(Table));
+    }
+}
+
+void FTomlDocument::BuildIndices(const toml::node& Node)
+{
+    if (const toml::table* Table = Node.as_table())
+    {
+        if (bIndexTables && Table->size() >= Toml::MinIndexedTableSize)
+        {
+            TableIndices.Add(Table, FTomlTableIndex(*Table));
+        }
+        for (auto&& [Key, Value] : *Table)
+        {
+            BuildIndices(Value);
+        }
+    }
+    else if (const toml::array* Array = Node.as_array())
+    {
+        // Integer and float arrays are packed by FindPackedArray once they are viewed
+        for (const toml::node& Element : *Array)
+        {
+            BuildIndices(Element);
+        }
+    }
+}
+
+void FTomlDocument::RemoveIndices(const toml::node& Node)
+{
+    if (const toml::table* Table = Node.as_table())
+    {
+        TableIndices.Remove(Table);
+        NameIndices.Remove(Table);
+        for (auto&& [Key, Value] : *Table)
+        {
+            RemoveIndices(Value);
+        }
+    }
+    else if (const toml::array* Array = Node.as_array())
+    {
+        PackedIntegers.Remove(Array);
+        PackedFloats.Remove(Array);
+        for (const toml::node& Element : *Array)
+        {
+            RemoveIndices(Element);
+        }
+    }
+}
+
+const FTomlDocument::FNameIndex::FEntry* FTomlDocument::FNameIndex::Find(FName Name) const
+{
+    // Where names do not preserve case, every spelling of a name is the same name and compares equal here
+    const auto IsSameSpelling = [Name](const FEntry& Entry)
+    {
+        return Entry.Name.IsEqual(Name, ENameCase::CaseSensitive);
+    };
+
+    const FEntry* Entry = Entries.Find(Name);
+    if (!Entry || IsSameSpelling(*Entry))
+    {
+        return Entry;
+    }
+    return CaseVariants.FindByPredicate(IsSameSpelling);
+}
+
+void FTomlDocument::FNameIndex::Add(FName Name, const toml::node* Node)
+{
+    if (Entries.Contains(Name))
+    {
+        CaseVariants.Add({ Name, Node });
+    }
+    else
+    {
+        Entries.Add(Name, { Name, Node });
+    }
+}
+
+SIZE_T FTomlDocument::FNameIndex::GetAllocatedSize() const
+{
+    return Entries.GetAllocatedSize() + CaseVariants.GetAllocatedSize();
+}
+
+const toml::node* FTomlDocument::FindNode(const toml::table& Table, FName Name) const
+{
+    {
+        FReadScopeLock ReadLock(NameIndicesLock);
+        if (const TUniquePtr<FNameIndex>* NameIndex = NameIndices.Find(&Table))
+        {
+            if (const FNameIndex::FEntry* Entry = (*NameIndex)->Find(Name))
+            {
+                return Entry->Node;
+            }
+        }
+    }
+
+    // First lookup of the name in this table, resolved through its spelling like a string key
+    TStringBuilder<NAME_SIZE> NameString;
+    Name.AppendString(NameString);
+    const FTCHARToUTF8 Utf8Name(NameString.ToString(), NameString.Len());
+    const toml::node* Node = Toml::FindNode(Toml::AsNode(Table), TableIndices.Find(&Table), std::string_view(Utf8Name.Get(), Utf8Name.Length()));
+
+    SIZE_T AddedSize = 0;
+    {
+        LLM_SCOPE_BYTAG(Toml);
+        FWriteScopeLock WriteLock(NameIndicesLock);
+        TUniquePtr<FNameIndex>& NameIndex = NameIndices.FindOrAdd(&Table);
+        if (!NameIndex)
+        {
+            NameIndex = MakeUnique<FNameIndex>();
+        }
+        if (!NameIndex->Find(Name))
+        {
+            const SIZE_T OldSize = NameIndex->GetAllocatedSize();
+            NameIndex->Add(Name, Node);
+            AddedSize = NameIndex->GetAllocatedSize() - OldSize;
+        }
+    }
+    if (AddedSize > 0)
+    {
+        Toml::ChargeParseCache(*this, AddedSize);
+    }
+    return Node;
+}
+
+template<Toml::CPackedType NativeType>
+const TArray<NativeType>* FTomlDocument::FindExistingPackedArray(const toml::array& Array) const
+{
+    FReadScopeLock ReadLock(PackedArraysLock);
+    const TUniquePtr<TArray<NativeType>>* Found = GetPackedArrays<NativeType>().Find(&Array);
+    return Found ? Found->Get() : nullptr;
+}
+
+template<Toml::CPackedType NativeType>
+const TArray<NativeType>* FTomlDocument::FindPackedArray(const toml::array& Array) const
+{
+    if (const TArray<NativeType>* Existing = FindExistingPackedArray<NativeType>(Array))
+    {
+        return Existing;
+    }
+    // Checking the first element's type first keeps the scan of other arrays short
+    if (Array.empty() || !Array.front().is<NativeType>() || !Array.is_homogeneous<NativeType>())
+    {
+        return nullptr;
+    }
+
+    const TArray<NativeType>* Packed = nullptr;
+    SIZE_T BuiltSize = 0;
+    {
+        LLM_SCOPE_BYTAG(Toml);
+        FWriteScopeLock WriteLock(PackedArraysLock);
+        TUniquePtr<TArray<NativeType>>& NewPacked = GetPackedArrays<NativeType>().FindOrAdd(&Array);
+        if (!NewPacked)
+        {
+            NewPacked = MakeUnique<TArray<NativeType>>();
+            NewPacked->Reserve(static_cast<int32>(Array.size()));
+            for (const toml::node& Element : Array)
+            {
+                NewPacked->Add(Element.as<NativeType>()->get());
+            }
+            BuiltSize = NewPacked->GetAllocatedSize();
+        }
+        Packed = NewPacked.Get();
+    }
+    if (BuiltSize > 0)
+    {
+        Toml::ChargeParseCache(*this, BuiltSize);
+    }
+
+    // Packed copies are only removed while the document is uniquely owned, so they outlive the lock
+    return Packed;
+}
+
+template const TArray<int64>* FTomlDocument::FindPackedArray<int64>(const toml::array& Array) const;
+template const TArray<double>* FTomlDocument::FindPackedArray<double>(const toml::array& Array) const;
+template const TArray<int64>* FTomlDocument::FindExistingPackedArray<int64>(const toml::array& Array) const;
+template const TArray<double>* FTomlDocument::FindExistingPackedArray<double>(const toml::array& Array) const;
@@ -0,0 +1,111 @@
+#include "UnrealToml.h"
+#include "TomlPrivate.h"
+
+FTomlValueHandle::FTomlValueHandle()
+    : Node(nullptr)
+    , Generation(0)
+    , Type(static_cast<uint8>(toml::node_type::none))
+{
+}
+
+FTomlValueHandle::FTomlValueHandle(const FTomlDocumentPtr& InDocument, const FTomlNode* InNode)
+    : Document(InDocument)
+    , Node(InNode)
+    , Generation(InDocument->Generation)
+    , Type(static_cast<uint8>(Toml::AsValueNode(InNode).type()))
+{
+}
+
+bool FTomlValueHandle::IsValid() const
+{
+    const FTomlDocumentPtr PinnedDocument = Document.Pin();
+    return Node && PinnedDocument && PinnedDocument->Generation == Generation;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlValueHandle::Get() const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    T Value{};
+    const bool bRead = TryGet(Value);
+    checkf(bRead, TEXT("TOML value handle is not valid or not a %s"), Toml::GetTypeName<NativeType>());
+    return Value;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlValueHandle::Get(T Default) const
+{
+    T Value{};
+    return TryGet(Value) ? Value : Default;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+bool FTomlValueHandle::TryGet(T& OutValue) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    if (Type != static_cast<uint8>(toml::impl::node_type_of<NativeType>))
+    {
+        return false;
+    }
+    // Pinned for the duration of the read. The document may be released on another thread meanwhile, for example
+    // by the parse cache evicting it while a worker loads another file.
+    const FTomlDocumentPtr PinnedDocument = Document.Pin();
+    if (!PinnedDocument || PinnedDocument->Generation != Generation)
+    {
+        return false;
+    }
+
+    // The type tag was checked above, so the node is known to hold a NativeType
+    const NativeType& Value = static_cast<const toml::value<NativeType>&>(Toml::AsValueNode(Node)).get();
+    if constexpr (Toml::CValueType<T>)
+    {
+        OutValue = static_cast<T>(Value);
+    }
+    else if constexpr (Toml::CStringType<T>)
+    {
+        OutValue = UTF8_TO_TCHAR(Value.c_str());
+    }
+    return true;
+}
+
+template bool FTomlValueHandle::Get<bool>() const;
+template int32 FTomlValueHandle::Get<int32>() const;
+template int64 FTomlValueHandle::Get<int64>() const;
+template float FTomlValueHandle::Get<float>() const;
+template double FTomlValueHandle::Get<double>() const;
+template FString FTomlValueHandle::Get<FString>() const;
+
+template bool FTomlValueHandle::Get<bool>(bool Default) const;
+template int32 FTomlValueHandle::Get<int32>(int32 Default) const;
+template int64 FTomlValueHandle::Get<int64>(int64 Default) const;
+template float FTomlValueHandle::Get<float>(float Default) const;
+template double FTomlValueHandle::Get<double>(double Default) const;
+template FString FTomlValueHandle::Get<FString>(FString Default) const;
+
+template bool FTomlValueHandle::TryGet<bool>(bool& OutValue) const;
+template bool FTomlValueHandle::TryGet<int32>(int32& OutValue) const;
+template bool FTomlValueHandle::TryGet<int64>(int64& OutValue) const;
+template bool FTomlValueHandle::TryGet<float>(float& OutValue) const;
+template bool FTomlValueHandle::TryGet<double>(double& OutValue) const;
+template bool FTomlValueHandle::TryGet<FString>(FString& OutValue) const;
+
+FTomlValueHandle FTomlTable::GetHandle(const FString& Key) const
+{
+    checkf(Node, TEXT("Invalid TOML file"));
+    const toml::node* Found = Toml::FindNode(Node, Index, TCHAR_TO_UTF8(*Key));
+    return Found ? FTomlValueHandle(Document, Toml::AsNode(*Found)) : FTomlValueHandle();
+}
+
+FTomlValueHandle FTomlTable::GetHandleAtPath(const FString& Path) const
+{
+    checkf(Node, TEXT("Invalid TOML file"));
+    const toml::node* Found = Toml::AsTable(Node).at_path(TCHAR_TO_UTF8(*Path)).node();
+    return Found ? FTomlValueHandle(Document, Toml::AsNode(*Found)) : FTomlValueHandle();
+}
+
+FTomlValueHandle FTomlTable::GetHandleAtPath(const FTomlPath& Path) const
+{
+    checkf(Node, TEXT("Invalid TOML file"));
+    const toml::node* Found = FTomlPathResolver::FindNode(*this, Path);
+    return Found ? FTomlValueHandle(Document, Toml::AsNode(*Found)) : FTomlValueHandle();
+}
@@ -1,231 +1,556 @@
 #include "UnrealToml.h"
+#include "TomlPrivate.h"
 
-#include "Logging/LogMacros.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFile.h"
+#include "HAL/PlatformFileManager.h"
 #include "Misc/FileHelper.h"
+#include "Serialization/Archive.h"
 
-DEFINE_LOG_CATEGORY_STATIC(LogToml, Log, All);
+#include <istream>
 
-IMPLEMENT_MODULE(FUnrealTomlModule, UnrealToml)
+DEFINE_LOG_CATEGORY(LogToml);
+LLM_DEFINE_TAG(Toml);
 
-#define TOML_EXCEPTIONS 0
-#define TOML_ENABLE_WINDOWS_COMPAT 0
-#include "toml.hpp"
+IMPLEMENT_MODULE(FUnrealTomlModule, UnrealToml)
 
-struct FTomlFileImpl
+FTomlTable::FTomlTable()
+    : Node(nullptr)
+    , Index(nullptr)
+    , OwnedDocument(nullptr)
 {
-    toml::table tbl;
-};
+}
 
-FTomlTable::FTomlTable()
-    : Impl(nullptr)
+FTomlTable::FTomlTable(TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe> InDocument)
+    : FTomlTable(InDocument, Toml::AsNode(InDocument->Root))
 {
 }
 
-void FTomlTable::Init()
+FTomlTable::FTomlTable(TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe> InDocument, const FTomlNode* InNode)
+    : Document(MoveTemp(InDocument))
+    , Node(InNode)
+    , Index(Document->TableIndices.Find(&Toml::AsTable(InNode)))
+    , OwnedDocument(nullptr)
 {
-    Impl = new FTomlFileImpl{};
 }
 
-FTomlTable::FTomlTable(const FTomlTable& Other)
-    : Impl(new FTomlFileImpl{})
+// Copies share the parsed tree instead of duplicating it, MakeUnique copies it before a change
+FTomlTable::FTomlTable(const FTomlTable& Other) = default;
+FTomlTable& FTomlTable::operator=(const FTomlTable& Other) = default;
+
+FTomlTable::FTomlTable(FTomlTable&& Other) noexcept
+    : Document(MoveTemp(Other.Document))
+    , Node(Other.Node)
+    , Index(Other.Index)
+    , OwnedDocument(Other.OwnedDocument)
 {
-    if (Other.Impl)
-    {
-        Impl->tbl = Other.Impl->tbl;
-    }
+    Other.Node = nullptr;
+    Other.Index = nullptr;
+    Other.OwnedDocument = nullptr;
 }
 
-FTomlTable& FTomlTable::operator=(const FTomlTable& Other)
+FTomlTable& FTomlTable::operator=(FTomlTable&& Other) noexcept
 {
     if (this != &Other)
     {
-        if (!Impl)
-        {
-            Impl = new FTomlFileImpl{};
-        }
-        
-        if (Other.Impl)
-        {
-            Impl->tbl = Other.Impl->tbl;
-        }
-        else
-        {
-            Impl->tbl = toml::table{};
-        }
+        Document = MoveTemp(Other.Document);
+        Node = Other.Node;
+        Index = Other.Index;
+        OwnedDocument = Other.OwnedDocument;
+        Other.Node = nullptr;
+        Other.Index = nullptr;
+        Other.OwnedDocument = nullptr;
     }
     return *this;
 }
 
-FTomlTable::~FTomlTable()
-{
-    delete Impl;
-}
+FTomlTable::~FTomlTable() = default;
 
 bool FTomlTable::IsValid() const
 {
-    return Impl != nullptr;
+    return Node != nullptr;
 }
 
 bool FTomlTable::IsEmpty() const
 {
-    return IsValid() && Impl->tbl.empty();
+    return IsValid() && Toml::AsTable(Node).empty();
 }
 
 namespace Toml
 {
-    template<typename T>
-    struct UETypeToNativeType { using Type = T; };
-    template<>
-    struct UETypeToNativeType<int32> { using Type = int64; };
-    template<>
-    struct UETypeToNativeType<float> { using Type = double; };
-    template<>
-    struct UETypeToNativeType<FString> { using Type = std::string; };
-
-    [[noreturn]] inline void Unreachable()
-    {
-        // Uses compiler specific extensions if possible.
-        // Even if no extension is used, undefined behavior is still raised by
-        // an empty function body and the noreturn attribute.
-#if defined(_MSC_VER) && !defined(__clang__) // MSVC
-        __assume(false);
-#else // GCC, Clang
-        __builtin_unreachable();
-#endif
+    bool ExtractTable(toml::parse_result&& ParseResult, toml::table& OutTable, FString& OutError)
+    {
+        if (!ParseResult)
+        {
+            const auto& Error = ParseResult.error();
+            const auto& Source = Error.source();
+            OutError = FString::Printf(TEXT("%s %s(%d:%d, %d:%d)"),
+                UTF8_TO_TCHAR(Error.description().data()),
+                Source.path ? UTF8_TO_TCHAR(Source.path->data()) : TEXT(""),
+                Source.begin.line,
+                Source.end.line,
+                Source.begin.column,
+                Source.end.column);
+            return false;
+        }
+
+        OutTable = std::move(ParseResult).table();
+        return true;
     }
-    
-    template<typename T>
-    const TCHAR* GetTypeName()
+
+    bool ParseTomlTable(std::string_view Content, toml::table& OutTable, FString& OutError)
+    {
+        LLM_SCOPE_BYTAG(Toml);
+        return ExtractTable(toml::parse(Content), OutTable, OutError);
+    }
+
+    bool ParseTomlTable(std::istream& Content, toml::table& OutTable, FString& OutError)
     {
-        if constexpr (std::is_same_v<T, bool>)
+        LLM_SCOPE_BYTAG(Toml);
+        return ExtractTable(toml::parse(Content), OutTable, OutError);
+    }
+
+    // TOML documents are UTF-8 by definition, so the raw file bytes are handed to the parser as-is
+    // instead of round-tripping them through a UTF-16 FString.
+    std::string_view ToUtf8View(const TArray<uint8>& Bytes)
+    {
+        return std::string_view(reinterpret_cast<const char*>(Bytes.GetData()), Bytes.Num());
+    }
+
+    // Exposes an FArchive as a std::streambuf so toml++ can pull the document in chunks instead of
+    // requiring it to be fully resident in memory.
+    class FArchiveStreamBuffer final : public std::streambuf
+    {
+    public:
+        explicit FArchiveStreamBuffer(FArchive& InArchive)
+            : Archive(InArchive)
+            , ArchiveSize(InArchive.TotalSize())
         {
-            return TEXT("bool");
+            Buffer.SetNumUninitialized(ChunkSize);
+        }
+
+    protected:
+        virtual int_type underflow() override
+        {
+            if (gptr() < egptr())
+            {
+                return traits_type::to_int_type(*gptr());
+            }
+
+            const int64 Remaining = ArchiveSize - Archive.Tell();
+            if (Remaining <= 0 || Archive.IsError())
+            {
+                return traits_type::eof();
+            }
+
+            const int64 NumBytes = FMath::Min<int64>(Remaining, ChunkSize);
+            Archive.Serialize(Buffer.GetData(), NumBytes);
+            if (Archive.IsError())
+            {
+                return traits_type::eof();
+            }
+
+            setg(Buffer.GetData(), Buffer.GetData(), Buffer.GetData() + NumBytes);
+            return traits_type::to_int_type(*gptr());
         }
-        else if constexpr (std::is_same_v<T, int64>)
+
+        // toml++ rewinds after sniffing for a byte order mark, so positioning has to work
+        virtual pos_type seekoff(off_type Offset, std::ios_base::seekdir Direction, std::ios_base::openmode Mode) override
         {
-            return TEXT("integer");
+            if (Direction == std::ios_base::cur)
+            {
+                return seekpos(GetPosition() + Offset, Mode);
+            }
+            if (Direction == std::ios_base::beg)
+            {
+                return seekpos(Offset, Mode);
+            }
+            return pos_type(off_type(-1));
         }
-        else if constexpr (std::is_same_v<T, double>)
+
+        virtual pos_type seekpos(pos_type Position, std::ios_base::openmode Mode) override
         {
-            return TEXT("float-point");
+            const int64 TargetPosition = static_cast<int64>(Position);
+            if (!(Mode & std::ios_base::in) || TargetPosition < 0 || TargetPosition > ArchiveSize)
+            {
+                return pos_type(off_type(-1));
+            }
+
+            // Stay within the current chunk when possible, otherwise drop it and reposition the archive
+            const int64 ChunkEnd = Archive.Tell();
+            const int64 ChunkStart = ChunkEnd - (egptr() - eback());
+            if (TargetPosition >= ChunkStart && TargetPosition <= ChunkEnd)
+            {
+                setg(eback(), eback() + (TargetPosition - ChunkStart), egptr());
+            }
+            else
+            {
+                Archive.Seek(TargetPosition);
+                setg(nullptr, nullptr, nullptr);
+            }
+            return Position;
         }
-        else if (std::is_same_v<T, std::string>)
+
+    private:
+        int64 GetPosition() const
         {
-            return TEXT("string");
+            return Archive.Tell() - (egptr() - gptr());
         }
-        Unreachable();
+
+        static constexpr int32 ChunkSize = 64 * 1024;
+
+        FArchive& Archive;
+        int64 ArchiveSize;
+        TArray<char> Buffer;
+    };
+
+    // Parses Content, or reads the cooked form of FilePath instead if it was cooked from exactly Content
+    static bool ParseTomlFileContent(const FString& FilePath, std::string_view Content, uint64 ContentHash, toml::table& OutTable, FString& OutError)
+    {
+        return ReadCookedTomlFile(FilePath, Content, ContentHash, OutTable) || ParseTomlFile(Content, ContentHash, OutTable, OutError);
     }
 
-    bool ParseTomlTable(const TCHAR* Content, toml::table& OutTable, FString& OutError)
+    bool LoadTomlFile(const FString& FilePath, toml::table& OutTable, FString& OutError)
     {
-        auto ParseResult = toml::parse(TCHAR_TO_UTF8(Content));
-        if (!ParseResult)
+        TArray<uint8> FileContent;
+        if (!FFileHelper::LoadFileToArray(FileContent, *FilePath, FILEREAD_Silent))
         {
-            const auto& Error = ParseResult.error();
-            const auto& Source = Error.source();
-            OutError = FString::Printf(TEXT("%s %s(%d:%d, %d:%d)"),
-                UTF8_TO_TCHAR(Error.description().data()),
-                Source.path ? UTF8_TO_TCHAR(Source.path->data()) : TEXT(""),
-                Source.begin.line,
-                Source.end.line,
-                Source.begin.column,
-                Source.end.column);
+            // Packaged builds may only stage the cooked file
+            if (ReadCookedTomlFile(FilePath, OutTable))
+            {
+                return true;
+            }
+            OutError = FString::Printf(TEXT("Failed to read TOML file: %s"), *FilePath);
             return false;
         }
 
-        OutTable = std::move(ParseResult).table();
+        FString Error;
+        const std::string_view Content = ToUtf8View(FileContent);
+        if (!ParseTomlFileContent(FilePath, Content, HashContent(Content), OutTable, Error))
+        {
+            OutError = FString::Printf(TEXT("Failed to parse TOML file '%s': %s"), *FilePath, *Error);
+            return false;
+        }
         return true;
     }
+
+    FTomlDocumentPtr LoadTomlFile(const FString& FilePath, FString& OutError)
+    {
+        TArray<uint8> FileContent;
+        if (!FFileHelper::LoadFileToArray(FileContent, *FilePath, FILEREAD_Silent))
+        {
+            // Packaged builds may only stage the cooked file
+            if (FTomlDocumentPtr Document = LoadCookedTomlFile(FilePath))
+            {
+                return Document;
+            }
+            OutError = FString::Printf(TEXT("Failed to read TOML file: %s"), *FilePath);
+            return nullptr;
+        }
+        return LoadTomlFileContent(FilePath, ToUtf8View(FileContent), OutError);
+    }
+
+    FTomlDocumentPtr LoadTomlFileContent(const FString& FilePath, std::string_view Content, FString& OutError)
+    {
+        // The cooked file is only looked for on a parse cache miss
+        FString Error;
+        const uint64 ContentHash = HashContent(Content);
+        FTomlDocumentPtr Document = FindOrParseDocument(ContentHash, Content.size(), [&FilePath, Content, ContentHash](toml::table& OutTable, FString& OutParseError)
+        {
+            return ParseTomlFileContent(FilePath, Content, ContentHash, OutTable, OutParseError);
+        }, Error);
+        if (!Document)
+        {
+            OutError = FString::Printf(TEXT("Failed to parse TOML file '%s': %s"), *FilePath, *Error);
+        }
+        return Document;
+    }
 }
 
-FTomlTable FTomlTable::LoadFile(const FString& FilePath)
+FTomlTable FTomlTable::LoadFile(const FString& FilePath, ETomlLoadOptions Options)
 {
     FTomlTable Result;
     
-    FString FileContent;
-    if (!FFileHelper::LoadFileToString(FileContent, *FilePath))
+    FString Error;
+    FTomlDocumentPtr Document;
+    if (EnumHasAnyFlags(Options, ETomlLoadOptions::Lean))
     {
-        UE_LOG(LogToml, Error, TEXT("Failed to read TOML file: %s"), *FilePath);
-        return Result;
+        toml::table Table;
+        if (Toml::LoadTomlFile(FilePath, Table, Error))
+        {
+            Document = Toml::MakeDocument(std::move(Table), false);
+        }
+    }
+    else
+    {
+        Document = Toml::LoadTomlFile(FilePath, Error);
     }
     
-    FString Error;
-    Result.Init();
-    if (!Toml::ParseTomlTable(*FileContent, Result.Impl->tbl, Error))
+    if (Document)
+    {
+        Result = FTomlTable(MoveTemp(Document));
+    }
+    else
     {
-        UE_LOG(LogToml, Error, TEXT("Failed to parse TOML file '%s': %s"), *FilePath, *Error);
-        Result.Impl = nullptr;
+        UE_LOG(LogToml, Error, TEXT("%s"), *Error);
     }
     
     return Result;
 }
 
-FTomlTable FTomlTable::LoadString(const FString& Content)
+FTomlTable FTomlTable::LoadFileMapped(const FString& FilePath)
 {
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*FilePath));
+    if (!MappedFile)
+    {
+        UE_LOG(LogToml, Verbose, TEXT("Memory mapping unavailable for '%s', falling back to LoadFile"), *FilePath);
+        return LoadFile(FilePath);
+    }
+
     FTomlTable Result;
-    
+
+    // An empty file is a valid (empty) document, but cannot be mapped
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    std::string_view Content;
+    if (const int64 FileSize = MappedFile->GetFileSize(); FileSize > 0)
+    {
+        MappedRegion.Reset(MappedFile->MapRegion(0, FileSize));
+        if (!MappedRegion)
+        {
+            UE_LOG(LogToml, Error, TEXT("Failed to map TOML file: %s"), *FilePath);
+            return Result;
+        }
+        Content = std::string_view(reinterpret_cast<const char*>(MappedRegion->GetMappedPtr()), MappedRegion->GetMappedSize());
+    }
+
     FString Error;
-    Result.Init();
-    if (!Toml::ParseTomlTable(*Content, Result.Impl->tbl, Error))
+    if (FTomlDocumentPtr Document = Toml::LoadTomlFileContent(FilePath, Content, Error))
     {
-        UE_LOG(LogToml, Error, TEXT("Failed to parse TOML string: %s"), *Error);
-        Result.Impl = nullptr;
+        Result = FTomlTable(MoveTemp(Document));
     }
-    
+    else
+    {
+        UE_LOG(LogToml, Error, TEXT("%s"), *Error);
+    }
+
     return Result;
 }
 
-// Basic value getters - Checked variants
-template <typename T> requires Toml::CSupportedType<T>
-T FTomlTable::Get(const FString& Key) const
+TFuture<FTomlTable> FTomlTable::LoadFileAsync(const FString& FilePath)
 {
-    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
-    checkf(HasKey(Key), TEXT("Key '%s' not found in TOML file"), *Key);
-    auto node = Impl->tbl[TCHAR_TO_UTF8(*Key)];
-    checkf(node.is<NativeType>(), TEXT("Key '%s' is not a %s"), *Key, Toml::GetTypeName<NativeType>());
-    if constexpr (Toml::CValueType<T>)
+    return Async(EAsyncExecution::ThreadPool, [FilePath]()
     {
-        return static_cast<T>(node.as<NativeType>()->get());
+        return LoadFile(FilePath);
+    });
+}
+
+TArray<FTomlFileLoadResult> FTomlTable::LoadFilesParallel(const TArray<FString>& FilePaths)
+{
+    TArray<FTomlFileLoadResult> Results;
+    Results.Reserve(FilePaths.Num());
+    for (const FString& FilePath : FilePaths)
+    {
+        Results.Add({ FilePath });
     }
-    else if constexpr (Toml::CStringType<T>)
+
+    const double StartTime = FPlatformTime::Seconds();
+    ParallelFor(Results.Num(), [&Results](int32 Index)
+    {
+        FTomlFileLoadResult& Result = Results[Index];
+        const double FileStartTime = FPlatformTime::Seconds();
+        if (FTomlDocumentPtr Document = Toml::LoadTomlFile(Result.FilePath, Result.Error))
+        {
+            Result.Table = FTomlTable(MoveTemp(Document));
+        }
+        Result.LoadSeconds = FPlatformTime::Seconds() - FileStartTime;
+    }, EParallelForFlags::Unbalanced);
+    const double WallSeconds = FPlatformTime::Seconds() - StartTime;
+
+    // Report from the calling thread so the log stays in input order
+    double FileSeconds = 0.0;
+    int32 NumFailed = 0;
+    for (const FTomlFileLoadResult& Result : Results)
     {
-        auto& str = node.ref<NativeType>();
-        return UTF8_TO_TCHAR(str.data());
+        FileSeconds += Result.LoadSeconds;
+        if (Result.Table.IsValid())
+        {
+            UE_LOG(LogToml, Verbose, TEXT("Loaded TOML file '%s' in %.3f ms"), *Result.FilePath, Result.LoadSeconds * 1000.0);
+        }
+        else
+        {
+            UE_LOG(LogToml, Error, TEXT("%s"), *Result.Error);
+            ++NumFailed;
+        }
     }
-    Toml::Unreachable();
+    UE_LOG(LogToml, Log, TEXT("Loaded %d TOML files (%d failed) in %.3f ms, %.3f ms total file time"),
+        Results.Num(), NumFailed, WallSeconds * 1000.0, FileSeconds * 1000.0);
+
+    return Results;
 }
 
-// Basic value getters - with defaults
-template <typename T> requires Toml::CSupportedType<T>
-T FTomlTable::Get(const FString& Key, T Default) const
+FTomlTable FTomlTable::LoadString(const FString& Content, ETomlLoadOptions Options)
 {
-    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
-    auto node = Impl->tbl[TCHAR_TO_UTF8(*Key)];
-    if (!node.is<NativeType>())
+    FTomlTable Result;
+    
+    FTCHARToUTF8 Utf8Content(*Content);
+    const std::string_view Utf8View(Utf8Content.Get(), Utf8Content.Length());
+    
+    FString Error;
+    FTomlDocumentPtr Document;
+    if (EnumHasAnyFlags(Options, ETomlLoadOptions::Lean))
     {
-        return Default;
+        toml::table Table;
+        if (Toml::ParseTomlTable(Utf8View, Table, Error))
+        {
+            Document = Toml::MakeDocument(std::move(Table), false);
+        }
     }
-    if constexpr (Toml::CValueType<T>)
+    else
     {
-        return static_cast<T>(node.value_or(Default));
+        Document = Toml::FindOrParseDocument(Utf8View, [Utf8View](toml::table& OutTable, FString& OutParseError)
+        {
+            return Toml::ParseTomlTable(Utf8View, OutTable, OutParseError);
+        }, Error);
     }
-    else if constexpr (Toml::CStringType<T>)
+    
+    if (Document)
+    {
+        Result = FTomlTable(MoveTemp(Document));
+    }
+    else
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to parse TOML string: %s"), *Error);
+    }
+    
+    return Result;
+}
+
+FTomlTable FTomlTable::LoadArchive(FArchive& Archive)
+{
+    checkf(Archive.IsLoading(), TEXT("LoadArchive requires a loading archive"));
+
+    FTomlTable Result;
+    if (Archive.TotalSize() < 0)
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to read TOML archive '%s': size is unknown"), *Archive.GetArchiveName());
+        return Result;
+    }
+
+    Toml::FArchiveStreamBuffer StreamBuffer(Archive);
+    std::istream Stream(&StreamBuffer);
+
+    toml::table Table;
+    FString Error;
+    const bool bParsed = Toml::ParseTomlTable(Stream, Table, Error);
+    if (Archive.IsError())
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to read TOML archive '%s'"), *Archive.GetArchiveName());
+    }
+    else if (!bParsed)
+    {
+        UE_LOG(LogToml, Error, TEXT("Failed to parse TOML archive '%s': %s"), *Archive.GetArchiveName(), *Error);
+    }
+    else
     {
-        return UTF8_TO_TCHAR(node.value_or(TCHAR_TO_UTF8(*Default)));
+        Result = FTomlTable(Toml::MakeDocument(std::move(Table)));
     }
-    Toml::Unreachable();
+
+    return Result;
+}
+
+// Basic value getters - Checked variants
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlTable::Get(const FString& Key) const
+{
+    return GetUtf8<T>(Toml::AsUtf8View(FTCHARToUTF8(*Key)));
+}
+
+template <typename T>
+T FTomlTable::GetUtf8(FUtf8StringView Key) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    const toml::node* ValueNode = Toml::FindNode(Node, Index, Toml::ToStdView(Key));
+    checkf(ValueNode, TEXT("Key '%s' not found in TOML file"), *FString(Key));
+    T Value{};
+    const bool bRead = Toml::ReadValue(ValueNode, Value);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *FString(Key), Toml::GetTypeName<NativeType>());
+    return Value;
+}
+
+// Basic value getters - with defaults
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlTable::Get(const FString& Key, T Default) const
+{
+    return GetUtf8<T>(Toml::AsUtf8View(FTCHARToUTF8(*Key)), MoveTemp(Default));
+}
+
+template <typename T>
+T FTomlTable::GetUtf8(FUtf8StringView Key, T Default) const
+{
+    T Value{};
+    return TryGetUtf8(Key, Value) ? Value : Default;
+}
+
+// Optional getters
+template <typename T> requires Toml::CSupportedType<T>
+bool FTomlTable::TryGet(const FString& Key, T& OutValue) const
+{
+    return TryGetUtf8(Toml::AsUtf8View(FTCHARToUTF8(*Key)), OutValue);
+}
+
+template <typename T>
+bool FTomlTable::TryGetUtf8(FUtf8StringView Key, T& OutValue) const
+{
+    return Node && Toml::ReadValue(Toml::FindNode(Node, Index, Toml::ToStdView(Key)), OutValue);
 }
 
 template <typename T> requires Toml::CSupportedType<T>
 TArray<T> FTomlTable::GetHomoArray(const FString& Key) const
+{
+    return GetHomoArrayUtf8<T>(Toml::AsUtf8View(FTCHARToUTF8(*Key)));
+}
+
+template <typename T>
+TArray<T> FTomlTable::GetHomoArrayUtf8(FUtf8StringView Key) const
 {
     using NativeType = typename Toml::UETypeToNativeType<T>::Type;
-    checkf(HasKey(Key), TEXT("Key '%s' not found in TOML file"), *Key);
-    auto node = Impl->tbl[TCHAR_TO_UTF8(*Key)];
-    checkf(node.is_array(), TEXT("Key '%s' is not a array"), *Key);
-    checkf(node.is_homogeneous<NativeType>(), TEXT("Key '%s' is not homogeneous"), *Key);
+    const toml::node* ArrayNode = Toml::FindNode(Node, Index, Toml::ToStdView(Key));
+    checkf(ArrayNode, TEXT("Key '%s' not found in TOML file"), *FString(Key));
+    auto node = toml::node_view<const toml::node>(ArrayNode);
+    checkf(node.is_array(), TEXT("Key '%s' is not a array"), *FString(Key));
 
     auto arr = node.as_array();
+    if (arr->empty())
+    {
+        return {};
+    }
+    if constexpr (Toml::CPackedType<NativeType>)
+    {
+        // Copies out of a packed array left by GetHomoArrayView, this skips the homogeneity scan and the
+        // virtual node per element. Copies are never packed just for this.
+        if (const TArray<NativeType>* Packed = Document->FindExistingPackedArray<NativeType>(*arr))
+        {
+            if constexpr (std::is_same_v<T, NativeType>)
+            {
+                return *Packed;
+            }
+            else
+            {
+                TArray<T> Result;
+                Result.Reserve(Packed->Num());
+                for (const NativeType Element : *Packed)
+                {
+                    Result.Add(static_cast<T>(Element));
+                }
+                return Result;
+            }
+        }
+    }
+
+    checkf(node.is_homogeneous<NativeType>(), TEXT("Key '%s' is not homogeneous"), *FString(Key));
     TArray<T> Result;
     Result.Reserve(arr->size());
     arr->for_each([&Result](const toml::value<NativeType>& item)
@@ -247,50 +572,179 @@ TArray<T> FTomlTable::GetHomoArray(const FString& Key) const
     return Result;
 }
 
+template <typename T> requires Toml::CPackedType<T>
+TArrayView<const T> FTomlTable::GetHomoArrayView(const FString& Key) const
+{
+    const FTCHARToUTF8 Utf8Key(*Key);
+    const toml::node* ArrayNode = Toml::FindNode(Node, Index, Toml::ToStdView(Toml::AsUtf8View(Utf8Key)));
+    checkf(ArrayNode, TEXT("Key '%s' not found in TOML file"), *Key);
+    const toml::array* Array = ArrayNode->as_array();
+    checkf(Array, TEXT("Key '%s' is not a array"), *Key);
+    if (Array->empty())
+    {
+        return {};
+    }
+    const TArray<T>* Packed = Document->FindPackedArray<T>(*Array);
+    checkf(Packed, TEXT("Key '%s' is not homogeneous"), *Key);
+    return *Packed;
+}
+
 template <typename T> requires Toml::CSupportedType<T>
 T FTomlTable::AtPath(const FString& Path) const
+{
+    return AtPathUtf8<T>(Toml::AsUtf8View(FTCHARToUTF8(*Path)));
+}
+
+template <typename T>
+T FTomlTable::AtPathUtf8(FUtf8StringView Path) const
 {
     using NativeType = typename Toml::UETypeToNativeType<T>::Type;
-    auto node = Impl->tbl.at_path(TCHAR_TO_UTF8(*Path));
-    checkf(node.is<NativeType>(), TEXT("Key '%s' is not a %s"), *Path, Toml::GetTypeName<NativeType>());
-    if constexpr (Toml::CValueType<T>)
-    {
-        return static_cast<T>(node.as<NativeType>()->get());
-    }
-    else if constexpr (Toml::CStringType<T>)
-    {
-        auto& str = node.ref<NativeType>();
-        return UTF8_TO_TCHAR(str.data());
-    }
-    Toml::Unreachable();
+    T Value{};
+    const bool bRead = Toml::ReadValue(Toml::AsTable(Node).at_path(Toml::ToStdView(Path)).node(), Value);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *FString(Path), Toml::GetTypeName<NativeType>());
+    return Value;
 }
 
 template <typename T> requires Toml::CSupportedType<T>
 T FTomlTable::AtPath(const FString& Path, T Default) const
 {
-    auto node = Impl->tbl.at_path(TCHAR_TO_UTF8(*Path));
-    if constexpr (Toml::CValueType<T>)
+    return AtPathUtf8<T>(Toml::AsUtf8View(FTCHARToUTF8(*Path)), MoveTemp(Default));
+}
+
+template <typename T>
+T FTomlTable::AtPathUtf8(FUtf8StringView Path, T Default) const
+{
+    T Value{};
+    return TryAtPathUtf8(Path, Value) ? Value : Default;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+bool FTomlTable::TryAtPath(const FString& Path, T& OutValue) const
+{
+    return TryAtPathUtf8(Toml::AsUtf8View(FTCHARToUTF8(*Path)), OutValue);
+}
+
+template <typename T>
+bool FTomlTable::TryAtPathUtf8(FUtf8StringView Path, T& OutValue) const
+{
+    return Node && Toml::ReadValue(Toml::AsTable(Node).at_path(Toml::ToStdView(Path)).node(), OutValue);
+}
+
+namespace Toml
+{
+    const toml::node* FindNodeAtPath(const FTomlDocument& Document, const toml::table& Table, TArrayView<const FName> Path)
     {
-        return static_cast<T>(node.value_or(Default));
+        const toml::node* Current = &Table;
+        for (const FName& Segment : Path)
+        {
+            const toml::table* CurrentTable = Current->as_table();
+            Current = CurrentTable ? Document.FindNode(*CurrentTable, Segment) : nullptr;
+            if (!Current)
+            {
+                return nullptr;
+            }
+        }
+        return Current;
     }
-    else if constexpr (Toml::CStringType<T>)
+
+    FString PathToString(TArrayView<const FName> Path)
     {
-        return UTF8_TO_TCHAR(node.value_or(TCHAR_TO_UTF8(*Default)));
+        FString Result;
+        for (const FName& Segment : Path)
+        {
+            if (!Result.IsEmpty())
+            {
+                Result += TEXT(".");
+            }
+            Result += Segment.ToString();
+        }
+        return Result;
     }
-    Toml::Unreachable();
+}
+
+template <typename T, Toml::CNameType NameType> requires Toml::CSupportedType<T>
+T FTomlTable::Get(NameType Key) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    checkf(Node, TEXT("Invalid TOML file"));
+    const toml::node* ValueNode = Document->FindNode(Toml::AsTable(Node), Key);
+    checkf(ValueNode, TEXT("Key '%s' not found in TOML file"), *Key.ToString());
+    T Value{};
+    const bool bRead = Toml::ReadValue(ValueNode, Value);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *Key.ToString(), Toml::GetTypeName<NativeType>());
+    return Value;
+}
+
+template <typename T, Toml::CNameType NameType> requires Toml::CSupportedType<T>
+T FTomlTable::Get(NameType Key, T Default) const
+{
+    T Value{};
+    return Node && Toml::ReadValue(Document->FindNode(Toml::AsTable(Node), Key), Value) ? Value : Default;
+}
+
+template <Toml::CNameType NameType>
+bool FTomlTable::HasKey(NameType Key) const
+{
+    return Node && Document->FindNode(Toml::AsTable(Node), Key) != nullptr;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlTable::AtPath(const FTomlPath& Path) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    T Value{};
+    const bool bRead = Toml::ReadValue(FTomlPathResolver::FindNode(*this, Path), Value);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *Path.ToString(), Toml::GetTypeName<NativeType>());
+    return Value;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlTable::AtPath(const FTomlPath& Path, T Default) const
+{
+    T Value{};
+    return TryAtPath(Path, Value) ? Value : Default;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+bool FTomlTable::TryAtPath(const FTomlPath& Path, T& OutValue) const
+{
+    return Toml::ReadValue(FTomlPathResolver::FindNode(*this, Path), OutValue);
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlTable::AtPath(TArrayView<const FName> Path) const
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    checkf(Node, TEXT("Invalid TOML file"));
+    T Value{};
+    const bool bRead = Toml::ReadValue(Toml::FindNodeAtPath(*Document, Toml::AsTable(Node), Path), Value);
+    checkf(bRead, TEXT("Key '%s' is not a %s"), *Toml::PathToString(Path), Toml::GetTypeName<NativeType>());
+    return Value;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+T FTomlTable::AtPath(TArrayView<const FName> Path, T Default) const
+{
+    T Value{};
+    return Node && Toml::ReadValue(Toml::FindNodeAtPath(*Document, Toml::AsTable(Node), Path), Value) ? Value : Default;
 }
 
 bool FTomlTable::HasKey(const FString& Key) const
 {
-    return Impl->tbl.contains(TCHAR_TO_UTF8(*Key));
+    return HasKeyUtf8(Toml::AsUtf8View(FTCHARToUTF8(*Key)));
+}
+
+bool FTomlTable::HasKeyUtf8(FUtf8StringView Key) const
+{
+    return Toml::FindNode(Node, Index, Toml::ToStdView(Key)) != nullptr;
 }
 
 TArray<FString> FTomlTable::GetKeys() const
 {
     TArray<FString> Keys;
-    if (!Impl) return Keys;
+    if (!Node) return Keys;
     
-    for (const auto& [key, value] : Impl->tbl)
+    for (const auto& [key, value] : Toml::AsTable(Node))
     {
         Keys.Add(UTF8_TO_TCHAR(key.data()));
     }
@@ -300,29 +754,127 @@ TArray<FString> FTomlTable::GetKeys() const
 // Table getters
 FTomlTable FTomlTable::GetTable(const FString& Key) const
 {
-    checkf(Impl && HasKey(Key), TEXT("Key '%s' not found in TOML file"), *Key);
-    auto table = Impl->tbl[TCHAR_TO_UTF8(*Key)].as_table();
-    checkf(table != nullptr, TEXT("Key '%s' is not a table"), *Key);
+    return GetTableUtf8(Toml::AsUtf8View(FTCHARToUTF8(*Key)));
+}
 
-    FTomlTable Result;
-    Result.Init();
-    Result.Impl->tbl = MoveTemp(*table);
-    return Result;
+FTomlTable FTomlTable::GetTableUtf8(FUtf8StringView Key) const
+{
+    checkf(Node, TEXT("Invalid TOML file"));
+    const toml::node* TableNode = Toml::FindNode(Node, Index, Toml::ToStdView(Key));
+    checkf(TableNode, TEXT("Key '%s' not found in TOML file"), *FString(Key));
+    auto table = TableNode->as_table();
+    checkf(table != nullptr, TEXT("Key '%s' is not a table"), *FString(Key));
+
+    // The subtable shares the document instead of copying out of it
+    return FTomlTable(Document, Toml::AsNode(*table));
 }
 
 FTomlTable FTomlTable::GetTableAtPath(const FString& Path) const
 {
-    checkf(Impl, TEXT("Invalid TOML file"));
-    auto node = Impl->tbl.at_path(TCHAR_TO_UTF8(*Path));
+    checkf(Node, TEXT("Invalid TOML file"));
+    const FTCHARToUTF8 Utf8Path(*Path);
+    auto node = Toml::AsTable(Node).at_path(Toml::ToStdView(Toml::AsUtf8View(Utf8Path)));
     auto table = node.as_table();
     checkf(table != nullptr, TEXT("Path '%s' not found or not a table"), *Path);
 
-    FTomlTable Result{};
-    Result.Init();
-    Result.Impl->tbl = MoveTemp(*table);
-    return Result;
+    return FTomlTable(Document, Toml::AsNode(*table));
+}
+
+FTomlTable FTomlTable::GetTableAtPath(const FTomlPath& Path) const
+{
+    checkf(Node, TEXT("Invalid TOML file"));
+    const toml::node* Found = FTomlPathResolver::FindNode(*this, Path);
+    const toml::table* table = Found ? Found->as_table() : nullptr;
+    checkf(table != nullptr, TEXT("Path '%s' not found or not a table"), *Path.ToString());
+
+    return FTomlTable(Document, Toml::AsNode(*table));
+}
+
+FTomlDocument& FTomlTable::MakeUnique()
+{
+    LLM_SCOPE_BYTAG(Toml);
+    // Documents from the parse cache are shared with it, so the first change always copies them
+    if (!OwnedDocument || !Document.IsUnique())
+    {
+        const TSharedPtr<FTomlDocument, ESPMode::ThreadSafe> NewDocument = Toml::MakeDocument(toml::table(Toml::AsTable(Node)), Document->bIndexTables);
+        *this = FTomlTable(NewDocument);
+        OwnedDocument = NewDocument.Get();
+    }
+    return *OwnedDocument;
+}
+
+template <typename T> requires Toml::CSupportedType<T>
+void FTomlTable::Set(const FString& Key, T Value)
+{
+    using NativeType = typename Toml::UETypeToNativeType<T>::Type;
+    checkf(Node, TEXT("Invalid TOML file"));
+    LLM_SCOPE_BYTAG(Toml);
+    FTomlDocument& MutableDocument = MakeUnique();
+    const FTCHARToUTF8 Utf8Key(*Key);
+    const std::string_view KeyView = Toml::ToStdView(Toml::AsUtf8View(Utf8Key));
+    if constexpr (Toml::CValueType<T>)
+    {
+        MutableDocument.SetValue(Toml::AsTable(Node), KeyView, static_cast<NativeType>(Value));
+    }
+    else if constexpr (Toml::CStringType<T>)
+    {
+        const FTCHARToUTF8 Utf8Value(*Value);
+        MutableDocument.SetValue(Toml::AsTable(Node), KeyView, NativeType(Toml::ToStdView(Toml::AsUtf8View(Utf8Value))));
+    }
+    Index = MutableDocument.TableIndices.Find(&Toml::AsTable(Node));
 }
 
-template TArray<int32> FTomlTable::GetHomoArray<int32>(const FString& Key) const;
-template TArray<int64> FTomlTable::GetHomoArray<int64>(const FString& Key) const;
-template TArray<FString> FTomlTable::GetHomoArray<FString>(const FString& Key) const;
\ No newline at end of file
+bool FTomlTable::Remove(const FString& Key)
+{
+    checkf(Node, TEXT("Invalid TOML file"));
+    const FTCHARToUTF8 Utf8Key(*Key);
+    const std::string_view KeyView = Toml::ToStdView(Toml::AsUtf8View(Utf8Key));
+    // A shared document is only copied when there is a key to remove, otherwise RemoveValue does the only lookup
+    if (!Document.IsUnique() && !Toml::FindNode(Node, Index, KeyView))
+    {
+        return false;
+    }
+    LLM_SCOPE_BYTAG(Toml);
+    FTomlDocument& MutableDocument = MakeUnique();
+    const bool bRemoved = MutableDocument.RemoveValue(Toml::AsTable(Node), KeyView);
+    Index = MutableDocument.TableIndices.Find(&Toml::AsTable(Node));
+    return bRemoved;
+}
+
+template TArrayView<const int64> FTomlTable::GetHomoArrayView<int64>(const FString& Key) const;
+template TArrayView<const double> FTomlTable::GetHomoArrayView<double>(const FString& Key) const;
+
+#define UE_TOML_TABLE_INSTANTIATE(Type) \
+    template Type FTomlTable::Get<Type>(const FString& Key) const; \
+    template Type FTomlTable::Get<Type>(const FString& Key, Type Default) const; \
+    template Type FTomlTable::GetUtf8<Type>(FUtf8StringView Key) const; \
+    template Type FTomlTable::GetUtf8<Type>(FUtf8StringView Key, Type Default) const; \
+    template TArray<Type> FTomlTable::GetHomoArray<Type>(const FString& Key) const; \
+    template TArray<Type> FTomlTable::GetHomoArrayUtf8<Type>(FUtf8StringView Key) const; \
+    template Type FTomlTable::AtPath<Type>(const FString& Path) const; \
+    template Type FTomlTable::AtPath<Type>(const FString& Path, Type Default) const; \
+    template Type FTomlTable::AtPathUtf8<Type>(FUtf8StringView Path) const; \
+    template Type FTomlTable::AtPathUtf8<Type>(FUtf8StringView Path, Type Default) const; \
+    template Type FTomlTable::Get<Type, FName>(FName Key) const; \
+    template Type FTomlTable::Get<Type, FName>(FName Key, Type Default) const; \
+    template Type FTomlTable::AtPath<Type>(TArrayView<const FName> Path) const; \
+    template Type FTomlTable::AtPath<Type>(TArrayView<const FName> Path, Type Default) const; \
+    template Type FTomlTable::AtPath<Type>(const FTomlPath& Path) const; \
+    template Type FTomlTable::AtPath<Type>(const FTomlPath& Path, Type Default) const; \
+    template bool FTomlTable::TryGet<Type>(const FString& Key, Type& OutValue) const; \
+    template bool FTomlTable::TryGetUtf8<Type>(FUtf8StringView Key, Type& OutValue) const; \
+    template bool FTomlTable::TryAtPath<Type>(const FString& Path, Type& OutValue) const; \
+    template bool FTomlTable::TryAtPathUtf8<Type>(FUtf8StringView Path, Type& OutValue) const; \
+    template bool FTomlTable::TryAtPath<Type>(const FTomlPath& Path, Type& OutValue) const; \
+    template void FTomlTable::Set<Type>(const FString& Key, Type Value);
+
+UE_TOML_TABLE_INSTANTIATE(bool)
+UE_TOML_TABLE_INSTANTIATE(int32)
+UE_TOML_TABLE_INSTANTIATE(int64)
+UE_TOML_TABLE_INSTANTIATE(float)
+UE_TOML_TABLE_INSTANTIATE(double)
+UE_TOML_TABLE_INSTANTIATE(FString)
+
+#undef UE_TOML_TABLE_INSTANTIATE
+
+template bool FTomlTable::HasKey<FName>(FName Key) const;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "UnrealToml.h"
+
+#include "Templates/SharedPointer.h"
+
+struct FTomlMappedFile;
+
+// Read-only view of a TOML document stored in the flat, offset-based layout written by Build.
+// Lookups walk relative offsets and sorted key tables directly in the buffer, so a memory-mapped
+// or otherwise resident buffer is usable immediately without parsing or allocating any nodes.
+// Views created from a TArrayView do not own the buffer, which must outlive them and every table obtained
+// from them. FromTable and the TArray overload of FromBuffer own the buffer instead, which then holds
+// the whole document in a single allocation that is released at once with the last table referencing it.
+class UNREALTOML_API FTomlFlatTable final
+{
+public:
+    // Writes Table in the flat layout, replacing the contents of OutBuffer
+    static void Build(const FTomlTable& Table, TArray<uint8>& OutBuffer);
+    // Returns an invalid view if Buffer does not hold a flat document
+    static FTomlFlatTable FromBuffer(TArrayView<const uint8> Buffer);
+    static FTomlFlatTable FromBuffer(TArray<uint8>&& Buffer);
+    // Flattens Table into a buffer owned by the result
+    static FTomlFlatTable FromTable(const FTomlTable& Table);
+    // Leaner still than FTomlTable::LoadFile and LoadString with ETomlLoadOptions::Lean. The parsed tree, with the
+    // source region toml++ keeps on every node and key, is released as soon as it has been flattened into a buffer
+    // owned by the result. GetAllocatedSize against FTomlTable::GetAllocatedSize gives the memory saved.
+    static FTomlFlatTable LoadFile(const FString& FilePath);
+    static FTomlFlatTable LoadString(const FString& Content);
+    // Maps the flat file FTomlTable::CookFile wrote for FilePath and reads it in place, so loading costs the same
+    // whatever the size of the document. The mapping lives as long as the tables obtained from it. The flat file is
+    // used as it is, without reading the source, so it must be cooked again after the source changes. Loads the
+    // source like LoadFile if there is no flat file.
+    static FTomlFlatTable LoadFileMapped(const FString& FilePath);
+    static FString GetCookedFilePath(const FString& FilePath);
+
+    FTomlFlatTable();
+
+    bool IsValid() const;
+    bool IsEmpty() const;
+
+    // Size of the buffer this table owns, shared with every table obtained from it. Views of a buffer owned
+    // elsewhere and mapped files report 0.
+    SIZE_T GetAllocatedSize() const;
+
+    // Basic value getters - Checked variants (with checkf assertion)
+    template<typename T> requires Toml::CSupportedType<T>
+    T Get(const FString& Key) const;
+
+    // Basic value getters - with defaults
+    template<typename T> requires Toml::CSupportedType<T>
+    T Get(const FString& Key, T Default) const;
+
+    // Array getters - Checked variants
+    template<typename T> requires Toml::CSupportedType<T>
+    TArray<T> GetHomoArray(const FString& Key) const;
+    // Reads a packed integer or float array in place, the buffer must be 8 byte aligned
+    template<typename T> requires Toml::CPackedType<T>
+    TArrayView<const T> GetHomoArrayView(const FString& Key) const;
+
+    // Path-based access - Checked variants
+    template<typename T> requires Toml::CSupportedType<T>
+    T AtPath(const FString& Path) const;
+
+    // Path-based access - with defaults
+    template<typename T> requires Toml::CSupportedType<T>
+    T AtPath(const FString& Path, T Default) const;
+
+    // Table operations
+    bool HasKey(const FString& Key) const;
+    TArray<FString> GetKeys() const;
+
+    // Table getters
+    FTomlFlatTable GetTable(const FString& Key) const;
+    FTomlFlatTable GetTableAtPath(const FString& Path) const;
+
+private:
+    FTomlFlatTable(TArrayView<const uint8> InBuffer, uint32 InTableOffset);
+
+    TArrayView<const uint8> Buffer;
+    uint32 TableOffset;
+    // Set when the table owns its buffer, shared with every table obtained from it
+    TSharedPtr<const TArray<uint8>, ESPMode::ThreadSafe> OwnedBuffer;
+    // Set when Buffer is a mapped file, likewise shared
+    TSharedPtr<const FTomlMappedFile, ESPMode::ThreadSafe> MappedFile;
+};
@@ -2,12 +2,23 @@
 
 #pragma once
 
+#include "Async/Future.h"
+#include "Containers/ArrayView.h"
+#include "Containers/StringView.h"
+#include "Misc/EnumClassFlags.h"
+#include "Misc/Optional.h"
 #include "Modules/ModuleManager.h"
+#include "Templates/SharedPointer.h"
+#include "UObject/NameTypes.h"
 
 class FUnrealTomlModule : public IModuleInterface
 {};
 
-struct FTomlFileImpl;
+struct FTomlDocument;
+struct FTomlNode;
+class FTomlTableIndex;
+struct FTomlFileLoadResult;
+struct FTomlPathResolver;
 
 namespace Toml
 {
@@ -27,28 +38,199 @@ namespace Toml
     concept CSupportedType =
         CValueType<T> ||
         CStringType<T>;
+
+    // Element types of the arrays kept packed for GetHomoArrayView
+    template<typename T>
+    concept CPackedType =
+        std::is_same_v<T, int64> ||
+        std::is_same_v<T, double>;
+
+    // Narrow keys are passed to toml++ as they are, without converting from TCHAR. Overloads deduce the key type,
+    // so narrow string literals match them exactly and prefer them to the FString overloads.
+    template<typename T>
+    concept CNarrowKeyType =
+        std::is_convertible_v<const T&, FAnsiStringView> ||
+        std::is_convertible_v<const T&, FUtf8StringView>;
+
+    // ANSI keys are read as UTF-8, which they are for the ASCII keys written in code
+    template<CNarrowKeyType T>
+    FUtf8StringView AsUtf8View(const T& Key)
+    {
+        if constexpr (std::is_convertible_v<const T&, FUtf8StringView>)
+        {
+            return Key;
+        }
+        else
+        {
+            const FAnsiStringView AnsiKey = Key;
+            return FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(AnsiKey.GetData()), AnsiKey.Len());
+        }
+    }
+
+    // Keeps the FName overloads out of overload resolution for string literals, which convert to both FString and FName
+    template<typename T>
+    concept CNameType =
+        std::is_same_v<T, FName>;
 }
 
+// Options of FTomlTable::LoadFile and LoadString
+enum class ETomlLoadOptions : uint8
+{
+    None = 0,
+    // Keeps no more than the parsed tree. The document is not shared through the parse cache, which would keep it
+    // alive after its last table, and tables get no hash index, so lookups in large tables search the tree.
+    // toml++ stores a source region inside every node and key, which only FTomlFlatTable::LoadFile and LoadString
+    // drop, see FTomlMemoryStats::SourceRegionBytes.
+    Lean = 1 << 0,
+};
+ENUM_CLASS_FLAGS(ETomlLoadOptions)
+
+// Estimated heap memory of a parsed document, see FTomlTable::GetAllocatedSize
+struct FTomlMemoryStats
+{
+    // Tables, arrays and values
+    SIZE_T NodeBytes = 0;
+    // Keys, including characters stored outside the key string
+    SIZE_T KeyBytes = 0;
+    // Source regions toml++ keeps inside every node and key, which the flat form does without
+    SIZE_T SourceRegionBytes = 0;
+    // Characters of string values stored outside the string object
+    SIZE_T StringBytes = 0;
+    // Tree nodes of the table maps and element pointers of the arrays
+    SIZE_T ContainerBytes = 0;
+    // Source path strings, counted once however many nodes share them
+    SIZE_T SourcePathBytes = 0;
+    // Table and name indices and packed arrays
+    SIZE_T IndexBytes = 0;
+
+    SIZE_T GetTotal() const
+    {
+        return NodeBytes + KeyBytes + SourceRegionBytes + StringBytes + ContainerBytes + SourcePathBytes + IndexBytes;
+    }
+};
+
+// Path in the syntax of FTomlTable::AtPath, parsed once so repeated lookups skip transcoding and tokenizing it
+class UNREALTOML_API FTomlPath final
+{
+public:
+    explicit FTomlPath(const FString& InPath);
+
+    // False if the path did not parse, lookups along it then find nothing
+    bool IsValid() const { return bValid; }
+    const FString& ToString() const { return Path; }
+
+private:
+    friend struct FTomlPathResolver;
+
+    struct FSegment
+    {
+        // Array index, INDEX_NONE for a key
+        int64 Index;
+        // UTF-8 bytes of the key in KeyBuffer, hashed like the table indices hash keys
+        int32 KeyOffset;
+        int32 KeyLength;
+        uint64 KeyHash;
+    };
+
+    FString Path;
+    TArray<FSegment> Segments;
+    TArray<ANSICHAR> KeyBuffer;
+    bool bValid;
+};
+
+// Reference to a single value, resolved once by FTomlTable::GetHandle or GetHandleAtPath so repeated reads skip
+// the key lookup. The handle does not keep the document alive, it becomes invalid when the document is released
+// or changed and has to be taken again from a table then.
+// Reads pin the document, so it may be released on any thread meanwhile. Changing the table a handle was taken
+// from through Set or Remove while another thread reads the handle is a race, like any other concurrent use of it.
+class UNREALTOML_API FTomlValueHandle final
+{
+public:
+    FTomlValueHandle();
+
+    // False if no value was found, or the document has been released or changed since
+    bool IsValid() const;
+
+    // Checked read, the value must still be valid and of type T
+    template<typename T> requires Toml::CSupportedType<T>
+    T Get() const;
+    template<typename T> requires Toml::CSupportedType<T>
+    T Get(T Default) const;
+    // Leaves OutValue untouched if the handle is invalid or the value is not of type T
+    template<typename T> requires Toml::CSupportedType<T>
+    bool TryGet(T& OutValue) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    TOptional<T> TryGet() const
+    {
+        T Value{};
+        return TryGet(Value) ? TOptional<T>(MoveTemp(Value)) : TOptional<T>();
+    }
+
+private:
+    friend class FTomlTable;
+
+    FTomlValueHandle(const TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe>& InDocument, const FTomlNode* InNode);
+
+    TWeakPtr<const FTomlDocument, ESPMode::ThreadSafe> Document;
+    // Node of any type, only dereferenced while Document is alive and still at Generation
+    const FTomlNode* Node;
+    uint32 Generation;
+    // toml::node_type of Node, type mismatches are rejected without pinning the document
+    uint8 Type;
+};
+
 class UNREALTOML_API FTomlTable final
 {
 public:
     // Factory methods - only way to create instances from outside
-    static FTomlTable LoadFile(const FString& FilePath);
-    static FTomlTable LoadString(const FString& Content);
+    // Prefers the cooked form of the file when it was cooked from the current source, see CookFile
+    static FTomlTable LoadFile(const FString& FilePath, ETomlLoadOptions Options = ETomlLoadOptions::None);
+    // Parses directly out of a memory-mapped view of the file, falls back to LoadFile where mapping is unsupported.
+    // A cooked form of the file is preferred like in LoadFile.
+    static FTomlTable LoadFileMapped(const FString& FilePath);
+    // Reads and parses the file on the thread pool, the future is fulfilled with an invalid table on failure
+    static TFuture<FTomlTable> LoadFileAsync(const FString& FilePath);
+    // Reads and parses all files concurrently, results are returned in the same order as FilePaths
+    static TArray<FTomlFileLoadResult> LoadFilesParallel(const TArray<FString>& FilePaths);
+    static FTomlTable LoadString(const FString& Content, ETomlLoadOptions Options = ETomlLoadOptions::None);
+    // Parses the remainder of a loading archive, streaming it through a fixed-size buffer
+    static FTomlTable LoadArchive(FArchive& Archive);
 
-    // Allow copying
+    // Allow copying, copies share the parsed document
     FTomlTable(const FTomlTable& Other);
     FTomlTable& operator=(const FTomlTable& Other);
+    // Moving transfers the document and leaves Other invalid
+    FTomlTable(FTomlTable&& Other) noexcept;
+    FTomlTable& operator=(FTomlTable&& Other) noexcept;
     ~FTomlTable();
 
     bool IsValid() const;
     bool IsEmpty() const;
 
+    // Memory of the whole document this table refers to, shared by every table obtained from the same load
+    FTomlMemoryStats GetAllocatedSize() const;
+
+    // Binary form of the parsed tree for cooked data, loading replaces this table
+    void Serialize(FArchive& Ar);
+    static FTomlTable LoadBinary(FArchive& Ar);
+    friend FArchive& operator<<(FArchive& Ar, FTomlTable& Table)
+    {
+        Table.Serialize(Ar);
+        return Ar;
+    }
+
+    // Parses FilePath and writes its binary form to GetCookedFilePath, tagged with the size and hash of the source
+    // bytes that were parsed. Also writes its flat form for FTomlFlatTable::LoadFileMapped. The cooked file is used while the source still hashes the same, or alone if the source
+    // is missing. The source is always read to verify it, the cooked file only saves the parse.
+    static bool CookFile(const FString& FilePath);
+    static FString GetCookedFilePath(const FString& FilePath);
+
     // Basic value getters - Checked variants (with checkf assertion)
     template<typename T> requires Toml::CSupportedType<T>
     T Get(const FString& Key) const;
 
     // Basic value getters - with defaults
+    // Like every getter, values are only read as their own type. An integer read as a float gives the default.
     template<typename T> requires Toml::CSupportedType<T>
     T Get(const FString& Key, T Default) const;
     
@@ -62,15 +244,19 @@ public:
     double GetFloat(const FString& Key, double Default) const { return Get(Key, Default); }
     FString GetString(const FString& Key, const FString& Default) const { return Get(Key, Default); }
     
-    // Array getters - Checked variants
+    // Array getters - Checked variants, empty arrays are empty for every T
     template<typename T> requires Toml::CSupportedType<T>
     TArray<T> GetHomoArray(const FString& Key) const;
+    // Integer and float arrays are packed on their first view, later views use the packed copy in place.
+    // The view stays valid while the document is alive and the array is not replaced.
+    template<typename T> requires Toml::CPackedType<T>
+    TArrayView<const T> GetHomoArrayView(const FString& Key) const;
     
     // Path-based access - Checked variants
     template<typename T> requires Toml::CSupportedType<T>
     T AtPath(const FString& Path) const;
     
-    // Path-based access - with defaults
+    // Path-based access - with defaults, the value must be of type T like for Get
     template<typename T> requires Toml::CSupportedType<T>
     T AtPath(const FString& Path, T Default) const;
 
@@ -83,6 +269,69 @@ public:
     int32 AtPathInt(const FString& Path, int32 Default) const { return AtPath(Path, Default); }
     double AtPathFloat(const FString& Path, double Default) const { return AtPath(Path, Default); }
     FString AtPathString(const FString& Path, const FString& Default) const { return AtPath(Path, Default); }
+
+    // Optional access with one lookup and no assertion. A missing key or a value of another type than T
+    // yields an unset optional, or false with OutValue left untouched.
+    template<typename T> requires Toml::CSupportedType<T>
+    bool TryGet(const FString& Key, T& OutValue) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    TOptional<T> TryGet(const FString& Key) const { return ToOptional<T>([&](T& Value) { return TryGet(Key, Value); }); }
+    template<typename T> requires Toml::CSupportedType<T>
+    bool TryAtPath(const FString& Path, T& OutValue) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    TOptional<T> TryAtPath(const FString& Path) const { return ToOptional<T>([&](T& Value) { return TryAtPath(Path, Value); }); }
+
+    // Narrow key overloads, see Toml::CNarrowKeyType
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    T Get(const KeyType& Key) const { return GetUtf8<T>(Toml::AsUtf8View(Key)); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    T Get(const KeyType& Key, T Default) const { return GetUtf8<T>(Toml::AsUtf8View(Key), MoveTemp(Default)); }
+    template<Toml::CNarrowKeyType KeyType>
+    bool HasKey(const KeyType& Key) const { return HasKeyUtf8(Toml::AsUtf8View(Key)); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    TArray<T> GetHomoArray(const KeyType& Key) const { return GetHomoArrayUtf8<T>(Toml::AsUtf8View(Key)); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    T AtPath(const KeyType& Path) const { return AtPathUtf8<T>(Toml::AsUtf8View(Path)); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    T AtPath(const KeyType& Path, T Default) const { return AtPathUtf8<T>(Toml::AsUtf8View(Path), MoveTemp(Default)); }
+    template<Toml::CNarrowKeyType KeyType>
+    FTomlTable GetTable(const KeyType& Key) const { return GetTableUtf8(Toml::AsUtf8View(Key)); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    bool TryGet(const KeyType& Key, T& OutValue) const { return TryGetUtf8(Toml::AsUtf8View(Key), OutValue); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    TOptional<T> TryGet(const KeyType& Key) const { return ToOptional<T>([&](T& Value) { return TryGetUtf8(Toml::AsUtf8View(Key), Value); }); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    bool TryAtPath(const KeyType& Path, T& OutValue) const { return TryAtPathUtf8(Toml::AsUtf8View(Path), OutValue); }
+    template<typename T, Toml::CNarrowKeyType KeyType> requires Toml::CSupportedType<T>
+    TOptional<T> TryAtPath(const KeyType& Path) const { return ToOptional<T>([&](T& Value) { return TryAtPathUtf8(Toml::AsUtf8View(Path), Value); }); }
+
+    // FName keyed access through a per-table cache of the names looked up so far, so only the first lookup of a
+    // name in a table transcodes it. Keys are never turned into names.
+    // Keys stay case sensitive: a name only finds the key spelled exactly like it. Where names do not preserve
+    // case (WITH_CASE_PRESERVING_NAME is 0), names differing only by case are one name, spelled like the name table
+    // first saw it, and only find the key spelled that way.
+    template<typename T, Toml::CNameType NameType> requires Toml::CSupportedType<T>
+    T Get(NameType Key) const;
+    template<typename T, Toml::CNameType NameType> requires Toml::CSupportedType<T>
+    T Get(NameType Key, T Default) const;
+    template<Toml::CNameType NameType>
+    bool HasKey(NameType Key) const;
+
+    // Precompiled paths
+    template<typename T> requires Toml::CSupportedType<T>
+    T AtPath(const FTomlPath& Path) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    T AtPath(const FTomlPath& Path, T Default) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    bool TryAtPath(const FTomlPath& Path, T& OutValue) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    TOptional<T> TryAtPath(const FTomlPath& Path) const { return ToOptional<T>([&](T& Value) { return TryAtPath(Path, Value); }); }
+
+    // Path of table keys, one FName per level
+    template<typename T> requires Toml::CSupportedType<T>
+    T AtPath(TArrayView<const FName> Path) const;
+    template<typename T> requires Toml::CSupportedType<T>
+    T AtPath(TArrayView<const FName> Path, T Default) const;
     
     // Table operations
     bool HasKey(const FString& Key) const;
@@ -91,11 +340,77 @@ public:
     // Table getters
     FTomlTable GetTable(const FString& Key) const;
     FTomlTable GetTableAtPath(const FString& Path) const;
+    FTomlTable GetTableAtPath(const FTomlPath& Path) const;
+
+    // Value handles for values read repeatedly, invalid if the key or path is not found
+    FTomlValueHandle GetHandle(const FString& Key) const;
+    FTomlValueHandle GetHandleAtPath(const FString& Path) const;
+    FTomlValueHandle GetHandleAtPath(const FTomlPath& Path) const;
+
+    // Mutators, copy-on-write: the first change to a loaded table deep-copies its whole document, which may be
+    // shared with the parse cache and other tables, later changes are made in place. Tables obtained from this one
+    // earlier do not see the change.
+    // The first change releases the loaded document if nothing else holds it, and with it every GetHomoArrayView
+    // view taken from this table. Later changes invalidate the views and value handles of the key they replace or
+    // remove, and of anything nested under it. Do not read handles taken from this table on other threads while
+    // changing it.
+    template<typename T> requires Toml::CSupportedType<T>
+    void Set(const FString& Key, T Value);
+    bool Remove(const FString& Key);
 
 private:
+    friend class FTomlFlatTable;
+    friend struct FTomlPathResolver;
+
     // Private constructor - only used internally
     FTomlTable();
-    void Init();
+    explicit FTomlTable(TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe> InDocument);
+    FTomlTable(TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe> InDocument, const FTomlNode* InNode);
+    // Gives this table a document of its own unless it already holds the only reference to the one it made
+    FTomlDocument& MakeUnique();
+
+    // Implement both the FString and the narrow key overloads
+    template<typename T>
+    T GetUtf8(FUtf8StringView Key) const;
+    template<typename T>
+    T GetUtf8(FUtf8StringView Key, T Default) const;
+    bool HasKeyUtf8(FUtf8StringView Key) const;
+    template<typename T>
+    TArray<T> GetHomoArrayUtf8(FUtf8StringView Key) const;
+    template<typename T>
+    T AtPathUtf8(FUtf8StringView Path) const;
+    template<typename T>
+    T AtPathUtf8(FUtf8StringView Path, T Default) const;
+    FTomlTable GetTableUtf8(FUtf8StringView Key) const;
+    template<typename T>
+    bool TryGetUtf8(FUtf8StringView Key, T& OutValue) const;
+    template<typename T>
+    bool TryAtPathUtf8(FUtf8StringView Path, T& OutValue) const;
+
+    // Runs the out parameter form of a Try getter and wraps its result
+    template<typename T, typename TryFunctionType>
+    static TOptional<T> ToOptional(TryFunctionType&& TryFunction)
+    {
+        T Value{};
+        return TryFunction(Value) ? TOptional<T>(MoveTemp(Value)) : TOptional<T>();
+    }
     
-    FTomlFileImpl* Impl;
+    // Keeps the document alive, Node is its root table or one of its subtables
+    TSharedPtr<const FTomlDocument, ESPMode::ThreadSafe> Document;
+    const FTomlNode* Node;
+    // Null if Node is too small to be indexed
+    const FTomlTableIndex* Index;
+    // The document MakeUnique made, changed in place while Document is its only reference
+    FTomlDocument* OwnedDocument;
+};
+
+struct FTomlFileLoadResult
+{
+    FString FilePath;
+    // Invalid if the file could not be read or parsed
+    FTomlTable Table;
+    // Empty on success
+    FString Error;
+    // Time spent reading and parsing this file
+    double LoadSeconds = 0.0;
 };
@@ -22,5 +22,10 @@ public class UnrealToml : ModuleRules
 			{
 			}
 		);
+
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+		}
 	}
 }
@@ -0,0 +1,61 @@
+#include "TomlCookCommandlet.h"
+
+#include "UnrealToml.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogTomlCook, Log, All);
+
+UTomlCookCommandlet::UTomlCookCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+int32 UTomlCookCommandlet::Main(const FString& Params)
+{
+    TArray<FString> Tokens;
+    TArray<FString> Switches;
+    TMap<FString, FString> ParamValues;
+    ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+    TArray<FString> Directories;
+    if (const FString* DirsParam = ParamValues.Find(TEXT("Dirs")))
+    {
+        DirsParam->ParseIntoArray(Directories, TEXT("+"));
+    }
+    else
+    {
+        Directories = { FPaths::ProjectContentDir(), FPaths::ProjectConfigDir() };
+    }
+
+    TArray<FString> FilePaths;
+    for (const FString& Directory : Directories)
+    {
+        IFileManager::Get().FindFilesRecursive(FilePaths, *Directory, TEXT("*.toml"), true, false, false);
+    }
+
+    UE_LOG(LogTomlCook, Display, TEXT("Cooking %d TOML files"), FilePaths.Num());
+
+    const double StartTime = FPlatformTime::Seconds();
+    std::atomic<int32> NumFailed = 0;
+    ParallelFor(FilePaths.Num(), [&FilePaths, &NumFailed](int32 Index)
+    {
+        if (!FTomlTable::CookFile(FilePaths[Index]))
+        {
+            ++NumFailed;
+        }
+    }, EParallelForFlags::Unbalanced);
+
+    UE_LOG(LogTomlCook, Display, TEXT("Cooked %d TOML files (%d failed) in %.3f s"),
+        FilePaths.Num(), NumFailed.load(), FPlatformTime::Seconds() - StartTime);
+
+    return NumFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "TomlCookCommandlet.generated.h"
+
+// Cooks every .toml file under the project Content and Config directories with FTomlTable::CookFile,
+// so packaged builds load the binary form instead of parsing.
+//
+// Usage: -run=TomlCook [-Dirs=Dir1+Dir2]
+UCLASS()
+class UTomlCookCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTomlCookCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};